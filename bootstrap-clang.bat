@@ -102,11 +102,11 @@ rem
 rem Note that echo does not override errorlevel.
 rem
 
-rem Filter out *.test.cxx sources.
+rem Filter out *.test.cxx and *.bench.cxx sources.
 rem
 set "r="
 for %%d in (%src%) do (
-  for /F "tokens=*" %%i in ('dir /b "%%d\*.cxx" ^| findstr /v "\.test\.cxx"') do set "r=!r! %%d\%%i"
+  for /F "tokens=*" %%i in ('dir /b "%%d\*.cxx" ^| findstr /v "\.test\.cxx \.bench\.cxx"') do set "r=!r! %%d\%%i"
 )
 
 echo on
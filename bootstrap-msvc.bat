@@ -134,13 +134,13 @@ set "obj="
 for %%d in (%src%) do (
   cd %%d
 
-  rem Filter out *.test.cxx sources.
+  rem Filter out *.test.cxx and *.bench.cxx sources.
   rem
   rem Note that we don't need to worry about *.obj since we clean them all up
   rem before compiling so after compiling we will only have the ones we need.
   rem
   set "r="
-  for /F "tokens=*" %%i in ('dir /b *.cxx ^| findstr /v "\.test\.cxx"') do set "r=!r! %%i"
+  for /F "tokens=*" %%i in ('dir /b *.cxx ^| findstr /v "\.test\.cxx \.bench\.cxx"') do set "r=!r! %%i"
 
   call :compile !r!
   if errorlevel 1 goto error
@@ -132,11 +132,11 @@ src="$src libbuild2/in/*.cxx"
 
 src="$src $libbutl/libbutl/*.cxx"
 
-# Filter out *.test.cxx sources.
+# Filter out *.test.cxx and *.bench.cxx sources.
 #
 r=
 for f in $src; do
-  if test -n "${f##*.test.cxx}"; then
+  if test -n "${f##*.test.cxx}" -a -n "${f##*.bench.cxx}"; then
     r="$r $f"
   fi
 done
@@ -680,6 +680,10 @@ namespace build2
     verbose_ (1),
     verbose_specified_ (false),
     stat_ (),
+    stat_file_ (),
+    stat_file_specified_ (false),
+    trace_file_ (),
+    trace_file_specified_ (false),
     dump_ (),
     dump_specified_ (false),
     progress_ (),
@@ -692,6 +696,8 @@ namespace build2
     queue_depth_specified_ (false),
     max_stack_ (),
     max_stack_specified_ (false),
+    jobserver_ (),
+    no_jobserver_ (),
     serial_stop_ (),
     dry_run_ (),
     match_only_ (),
@@ -823,6 +829,20 @@ namespace build2
         this->stat_, a.stat_);
     }
 
+    if (a.stat_file_specified_)
+    {
+      ::build2::cl::parser< path>::merge (
+        this->stat_file_, a.stat_file_);
+      this->stat_file_specified_ = true;
+    }
+
+    if (a.trace_file_specified_)
+    {
+      ::build2::cl::parser< path>::merge (
+        this->trace_file_, a.trace_file_);
+      this->trace_file_specified_ = true;
+    }
+
     if (a.dump_specified_)
     {
       ::build2::cl::parser< std::set<string>>::merge (
@@ -870,6 +890,18 @@ namespace build2
       this->max_stack_specified_ = true;
     }
 
+    if (a.jobserver_)
+    {
+      ::build2::cl::parser< bool>::merge (
+        this->jobserver_, a.jobserver_);
+    }
+
+    if (a.no_jobserver_)
+    {
+      ::build2::cl::parser< bool>::merge (
+        this->no_jobserver_, a.no_jobserver_);
+    }
+
     if (a.serial_stop_)
     {
       ::build2::cl::parser< bool>::merge (
@@ -1026,6 +1058,21 @@ namespace build2
     os << std::endl
        << "\033[1m--stat\033[0m                Display build statistics." << ::std::endl;
 
+    os << std::endl
+       << "\033[1m--stat-file\033[0m \033[4mpath\033[0m      Save the load statistics (the time spent loading each" << ::std::endl
+       << "                      \033[1mbuildfile\033[0m broken down into lexing, parsing, function" << ::std::endl
+       << "                      calls, etc., as well as the time spent booting and" << ::std::endl
+       << "                      initializing each module) to \033[4mpath\033[0m in the JSON format." << ::std::endl
+       << "                      Note that these statistics are also displayed by \033[1m--stat\033[0m." << ::std::endl;
+
+    os << std::endl
+       << "\033[1m--trace-file\033[0m \033[4mpath\033[0m     Record the build timeline and save it to \033[4mpath\033[0m in the" << ::std::endl
+       << "                      Chrome trace event format (which can be viewed with" << ::std::endl
+       << "                      \033[1mchrome://tracing\033[0m or Perfetto). The timeline includes rule" << ::std::endl
+       << "                      matching, applying, and recipe execution for each target," << ::std::endl
+       << "                      external processes, phase switches, as well as the time" << ::std::endl
+       << "                      threads spend blocked waiting for other tasks." << ::std::endl;
+
     os << std::endl
        << "\033[1m--dump\033[0m \033[4mphase\033[0m          Dump the build system state after the specified phase." << ::std::endl
        << "                      Valid \033[4mphase\033[0m values are \033[1mload\033[0m (after loading \033[1mbuildfiles\033[0m)" << ::std::endl
@@ -1077,6 +1124,25 @@ namespace build2
        << "                      value indicating that the main thread stack size should" << ::std::endl
        << "                      be used as is." << ::std::endl;
 
+    os << std::endl
+       << "\033[1m--jobserver\033[0m           Act as a GNU make jobserver for the child processes" << ::std::endl
+       << "                      (compilers, nested build system invocations, etc) unless" << ::std::endl
+       << "                      already running as a jobserver client (see" << ::std::endl
+       << "                      \033[1m--no-jobserver\033[0m). In this mode the total number of jobs" << ::std::endl
+       << "                      performed by the build system and the child processes" << ::std::endl
+       << "                      that support the jobserver protocol is limited to the" << ::std::endl
+       << "                      \033[1m--jobs|-j\033[0m value. Note that on POSIX the jobserver is a" << ::std::endl
+       << "                      named pipe which is only supported by GNU make 4.4 and" << ::std::endl
+       << "                      later." << ::std::endl;
+
+    os << std::endl
+       << "\033[1m--no-jobserver\033[0m        Don't act as a GNU make jobserver client. By default, if" << ::std::endl
+       << "                      the \033[1mMAKEFLAGS\033[0m environment variable specifies a jobserver" << ::std::endl
+       << "                      (for example, because the build system is executed by GNU" << ::std::endl
+       << "                      make with the \033[1m-j\033[0m option), then an additional token is" << ::std::endl
+       << "                      acquired from this jobserver for each concurrently" << ::std::endl
+       << "                      performed job besides the first." << ::std::endl;
+
     os << std::endl
        << "\033[1m--serial-stop\033[0m|\033[1m-s\033[0m      Run serially and stop at the first error. This mode is" << ::std::endl
        << "                      useful to investigate build failures that are caused by" << ::std::endl
@@ -1216,6 +1282,12 @@ namespace build2
         &options::verbose_specified_ >;
       _cli_options_map_["--stat"] = 
       &::build2::cl::thunk< options, bool, &options::stat_ >;
+      _cli_options_map_["--stat-file"] = 
+      &::build2::cl::thunk< options, path, &options::stat_file_,
+        &options::stat_file_specified_ >;
+      _cli_options_map_["--trace-file"] = 
+      &::build2::cl::thunk< options, path, &options::trace_file_,
+        &options::trace_file_specified_ >;
       _cli_options_map_["--dump"] = 
       &::build2::cl::thunk< options, std::set<string>, &options::dump_,
         &options::dump_specified_ >;
@@ -1244,6 +1316,10 @@ namespace build2
       _cli_options_map_["--max-stack"] = 
       &::build2::cl::thunk< options, size_t, &options::max_stack_,
         &options::max_stack_specified_ >;
+      _cli_options_map_["--jobserver"] = 
+      &::build2::cl::thunk< options, bool, &options::jobserver_ >;
+      _cli_options_map_["--no-jobserver"] = 
+      &::build2::cl::thunk< options, bool, &options::no_jobserver_ >;
       _cli_options_map_["--serial-stop"] = 
       &::build2::cl::thunk< options, bool, &options::serial_stop_ >;
       _cli_options_map_["-s"] = 
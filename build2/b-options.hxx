@@ -474,6 +474,18 @@ namespace build2
     const bool&
     stat () const;
 
+    const path&
+    stat_file () const;
+
+    bool
+    stat_file_specified () const;
+
+    const path&
+    trace_file () const;
+
+    bool
+    trace_file_specified () const;
+
     const std::set<string>&
     dump () const;
 
@@ -510,6 +522,12 @@ namespace build2
     bool
     max_stack_specified () const;
 
+    const bool&
+    jobserver () const;
+
+    const bool&
+    no_jobserver () const;
+
     const bool&
     serial_stop () const;
 
@@ -605,6 +623,10 @@ namespace build2
     uint16_t verbose_;
     bool verbose_specified_;
     bool stat_;
+    path stat_file_;
+    bool stat_file_specified_;
+    path trace_file_;
+    bool trace_file_specified_;
     std::set<string> dump_;
     bool dump_specified_;
     bool progress_;
@@ -617,6 +639,8 @@ namespace build2
     bool queue_depth_specified_;
     size_t max_stack_;
     bool max_stack_specified_;
+    bool jobserver_;
+    bool no_jobserver_;
     bool serial_stop_;
     bool dry_run_;
     bool match_only_;
@@ -302,6 +302,30 @@ namespace build2
     return this->stat_;
   }
 
+  inline const path& options::
+  stat_file () const
+  {
+    return this->stat_file_;
+  }
+
+  inline bool options::
+  stat_file_specified () const
+  {
+    return this->stat_file_specified_;
+  }
+
+  inline const path& options::
+  trace_file () const
+  {
+    return this->trace_file_;
+  }
+
+  inline bool options::
+  trace_file_specified () const
+  {
+    return this->trace_file_specified_;
+  }
+
   inline const std::set<string>& options::
   dump () const
   {
@@ -374,6 +398,18 @@ namespace build2
     return this->max_stack_specified_;
   }
 
+  inline const bool& options::
+  jobserver () const
+  {
+    return this->jobserver_;
+  }
+
+  inline const bool& options::
+  no_jobserver () const
+  {
+    return this->no_jobserver_;
+  }
+
   inline const bool& options::
   serial_stop () const
   {
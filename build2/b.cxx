@@ -12,7 +12,7 @@
 #endif
 
 #include <sstream>
-#include <cstring>   // strcmp(), strchr()
+#include <cstring>   // strcmp(), strchr(), strlen()
 #include <typeinfo>
 #include <iostream>  // cout
 #include <exception> // terminate(), set_terminate(), terminate_handler
@@ -35,7 +35,11 @@
 #include <libbuild2/context.hxx>
 #include <libbuild2/variable.hxx>
 #include <libbuild2/algorithm.hxx>
+#include <libbuild2/jobserver.hxx>
 #include <libbuild2/operation.hxx>
+#include <libbuild2/timeline.hxx>
+#include <libbuild2/load-stat.hxx>
+#include <libbuild2/memory-stat.hxx>
 #include <libbuild2/filesystem.hxx>
 #include <libbuild2/diagnostics.hxx>
 #include <libbuild2/prerequisite.hxx>
@@ -223,8 +227,21 @@ main (int argc, char* argv[])
          << system_error (errno, generic_category ()); // Sanitize.
 #endif
 
+  // Note that the jobserver and the timeline must outlive the scheduler.
+  //
+  unique_ptr<jobserver> js;
+  unique_ptr<timeline> tl;
   scheduler sched;
 
+  // The longest critical path, the largest target arena, and the memory
+  // usage of the largest build state across all the contexts as well as the
+  // load statistics of all the contexts (see --stat).
+  //
+  critical_path cpath;
+  size_t arena_bytes (0);
+  memory_stat mstat;
+  load_stat lstat;
+
   // Parse the command line.
   //
   try
@@ -559,13 +576,50 @@ main (int argc, char* argv[])
         fail << "invalid --max-jobs|-J value";
     }
 
+    // Connect to the outer jobserver or, if requested, become one for our
+    // child processes. Note that we export the jobserver by modifying our
+    // own environment which is inherited by all the processes we start. So
+    // this must be done before any threads are started.
+    //
+    if (jobs != 1)
+    {
+      try
+      {
+        if (!ops.no_jobserver ())
+          js = jobserver::client ();
+
+        if (js == nullptr && ops.jobserver ())
+        {
+          js = jobserver::server (jobs);
+          setenv ("MAKEFLAGS", js->makeflags ());
+        }
+      }
+      catch (const system_error& e)
+      {
+        warn << "unable to use jobserver: " << e <<
+          info << "continuing without jobserver";
+
+        js = nullptr;
+      }
+    }
+
+    // Start recording the build timeline, if requested. Note that this
+    // must be done before any threads are started.
+    //
+    if (ops.trace_file_specified ())
+    {
+      tl.reset (new timeline (ops.trace_file ()));
+      build_timeline = tl.get ();
+    }
+
     sched.startup (jobs,
                    1,
                    max_jobs,
                    jobs * ops.queue_depth (),
                    (ops.max_stack_specified ()
                     ? optional<size_t> (ops.max_stack () * 1024)
-                    : nullopt));
+                    : nullopt),
+                   js.get ());
 
     global_mutexes mutexes (sched.shard_size ());
 
@@ -580,6 +634,7 @@ main (int argc, char* argv[])
       trace << "path: " << (p ? *p : "<NULL>");
       trace << "type: " << (build_installed ? "installed" : "development");
       trace << "jobs: " << jobs;
+      trace << "jobserver: " << (js != nullptr ? "yes" : "no");
     }
 
     // Set the build context before parsing the buildspec since it relies on
@@ -587,8 +642,39 @@ main (int argc, char* argv[])
     // below).
     //
     unique_ptr<context> ctx;
-    auto new_context = [&ctx, &sched, &mutexes, &cmd_vars]
+
+    auto save_stat = [&ctx, &cpath, &arena_bytes, &mstat] ()
     {
+      if (ctx != nullptr)
+      {
+        critical_path& p (ctx->durations.critical_path);
+
+        if (p.duration > cpath.duration)
+          cpath = move (p);
+
+        arena_bytes = max (arena_bytes, ctx->target_arena.allocated ());
+
+        // Walking the build state is not free so only do it if requested.
+        //
+        if (ops.stat ())
+        {
+          memory_stat m (memory_usage (*ctx));
+
+          if (m.total () > mstat.total ())
+            mstat = move (m);
+        }
+      }
+    };
+
+    // Note: must be destroyed before ctx.
+    //
+    auto stat_guard (make_guard (save_stat));
+
+    auto new_context = [&ctx, &sched, &mutexes, &cmd_vars, &save_stat,
+                        &lstat]
+    {
+      save_stat ();
+
       ctx = nullptr; // Free first.
       ctx.reset (new context (sched,
                               mutexes,
@@ -596,6 +682,9 @@ main (int argc, char* argv[])
                               ops.dry_run (),
                               !ops.serial_stop () /* keep_going */,
                               cmd_vars));
+
+      if (ops.stat () || ops.stat_file_specified ())
+        ctx->load_stat = &lstat;
     };
 
     new_context ();
@@ -789,6 +878,10 @@ main (int argc, char* argv[])
 
         ctx->current_oname = oname; // Set early.
 
+        // The previous operation may have changed the filesystem.
+        //
+        ctx->filesystem_cache.clear ();
+
         if (lifted != nullptr)
           lifted = nullptr; // Clear for the next iteration.
 
@@ -931,7 +1024,7 @@ main (int argc, char* argv[])
 
             // If the src_base was explicitly specified, search for src_root.
             //
-            src_root = find_src_root (src_base, altn);
+            src_root = find_src_root (*ctx, src_base, altn);
 
             // If not found, assume this is a simple project with src_root
             // being the same as src_base.
@@ -961,7 +1054,7 @@ main (int argc, char* argv[])
           {
             // If no src_base was explicitly specified, search for out_root.
             //
-            auto p (find_out_root (out_base, altn));
+            auto p (find_out_root (*ctx, out_base, altn));
 
             if (p.second) // Also src_root.
             {
@@ -1663,6 +1756,40 @@ main (int argc, char* argv[])
   //
   assert (st.task_queue_remain == 0);
 
+  // Now that all the threads are done, save the build timeline.
+  //
+  if (tl != nullptr)
+  {
+    build_timeline = nullptr;
+
+    try
+    {
+      tl->write ();
+    }
+    catch (const io_error& e)
+    {
+      error << "unable to write to " << tl->file () << ": " << e;
+      r = 1;
+    }
+  }
+
+  if (ops.stat_file_specified ())
+  {
+    const path& f (ops.stat_file ());
+
+    try
+    {
+      ofdstream os (f);
+      lstat.write_json (os);
+      os.close ();
+    }
+    catch (const io_error& e)
+    {
+      error << "unable to write to " << f << ": " << e;
+      r = 1;
+    }
+  }
+
   if (ops.stat ())
   {
     text << '\n'
@@ -1676,7 +1803,125 @@ main (int argc, char* argv[])
          << "  task_queue_full        " << st.task_queue_full       << '\n'
          << '\n'
          << "  wait_queue_slots       " << st.wait_queue_slots      << '\n'
-         << "  wait_queue_collisions  " << st.wait_queue_collisions << '\n';
+         << "  wait_queue_collisions  " << st.wait_queue_collisions << '\n'
+         << "  wait_spin_hits         " << st.wait_spin_hits        << '\n'
+         << '\n'
+         << "  target_arena_bytes     " << arena_bytes              << '\n';
+
+    // Print the approximate memory usage by subsystem (number of objects and
+    // kilobytes) followed by the number of targets of each type, most common
+    // first.
+    //
+    if (mstat.total () != 0)
+    {
+      diag_record dr (text);
+
+      auto print = [&dr] (const char* n, const memory_stat::entry& e)
+      {
+        dr << "\n    " << n << string (20 - strlen (n), ' ')
+           << e.count << ' ' << e.bytes / 1024 << "KB";
+      };
+
+      dr << '\n'
+         << "  memory                 " << mstat.total () / 1024 << "KB";
+
+      print ("targets",         mstat.targets);
+      print ("target_names",    mstat.target_names);
+      print ("prerequisites",   mstat.prerequisites);
+      print ("target_vars",     mstat.target_vars);
+      print ("scopes",          mstat.scopes);
+      print ("scope_vars",      mstat.scope_vars);
+      print ("variable_caches", mstat.variable_caches);
+      print ("variable_pool",   mstat.variable_pool);
+      print ("functions",       mstat.functions);
+
+      vector<pair<size_t, const string*>> tts;
+      for (const auto& p: mstat.target_types)
+        tts.emplace_back (p.second, &p.first);
+
+      sort (tts.begin (), tts.end (),
+            [] (const pair<size_t, const string*>& x,
+                const pair<size_t, const string*>& y)
+            {
+              return x.first > y.first;
+            });
+
+      dr << '\n' << '\n'
+         << "  target_types";
+
+      for (const pair<size_t, const string*>& t: tts)
+        dr << "\n    " << t.first << ' ' << *t.second << "{}";
+    }
+
+    // Print the critical path as milliseconds of each target's own
+    // execution time, from the last executed target to the first.
+    //
+    if (cpath.duration != 0)
+    {
+      diag_record dr (text);
+
+      dr << '\n'
+         << "  critical_path          " << cpath.duration / 1000000 << "ms";
+
+      for (const pair<string, uint64_t>& t: cpath.targets)
+        dr << "\n    " << t.second / 1000000 << "ms " << t.first;
+    }
+
+    // Print the time spent loading the most expensive buildfiles (the
+    // inclusive time followed by the self time of each activity, in
+    // milliseconds) and then the time spent booting and initializing each
+    // module, most expensive first.
+    //
+    if (lstat.total != 0)
+    {
+      diag_record dr (text);
+
+      auto ms = [] (uint64_t ns, size_t w = 9)
+      {
+        string r (to_string (ns / 1000000));
+        r += '.';
+        r += static_cast<char> ('0' + ns / 100000 % 10);
+        return r.size () < w ? string (w - r.size (), ' ') + r : r;
+      };
+
+      dr << '\n'
+         << "  load                   " << ms (lstat.total, 0) << "ms" << '\n'
+         << "\n    " << "    total";
+
+      for (const char* n: load_stat::activity_names)
+        dr << string (9 - strlen (n), ' ') << n;
+
+      size_t n (0);
+      for (const auto* p: lstat.sorted_buildfiles ())
+      {
+        if (n++ == 20)
+        {
+          dr << "\n    ...";
+          break;
+        }
+
+        const load_stat::entry& e (p->second);
+
+        dr << "\n    " << ms (e.total);
+
+        for (uint64_t t: e.self)
+          dr << ms (t);
+
+        dr << ' ' << p->first;
+
+        if (e.count > 1)
+          dr << " (" << e.count << " times)";
+      }
+
+      if (!lstat.modules.empty ())
+      {
+        dr << '\n' << '\n'
+           << "  load_modules";
+
+        for (const auto* p: lstat.sorted_modules ())
+          dr << "\n    " << ms (p->second.total, 0) << "ms " << p->first;
+      }
+    }
   }
 
   return r;
@@ -56,7 +56,7 @@ namespace build2
       ctx.targets.insert<cxx::cxx> (d, o, n, trace);
       ctx.targets.insert<cxx::ixx> (d, o, n, trace);
 
-      return new cli_cxx (ctx, move (d), move (o), move (n));
+      return new (ctx) cli_cxx (ctx, move (d), move (o), move (n));
     }
 
     const target_type cli_cxx::static_type
@@ -3,12 +3,15 @@
 
 #include <libbuild2/algorithm.hxx>
 
+#include <sstream>
+
 #include <libbuild2/scope.hxx>
 #include <libbuild2/target.hxx>
 #include <libbuild2/rule.hxx>
 #include <libbuild2/file.hxx> // import()
 #include <libbuild2/search.hxx>
 #include <libbuild2/context.hxx>
+#include <libbuild2/timeline.hxx>
 #include <libbuild2/filesystem.hxx>
 #include <libbuild2/diagnostics.hxx>
 #include <libbuild2/prerequisite.hxx>
@@ -253,6 +256,9 @@ namespace build2
       s.rule = nullptr;
       s.dependents.store (0, memory_order_release);
 
+      s.priority.store (0, memory_order_relaxed);
+      s.finished = 0;
+
       offset = target::offset_touched;
     }
     else
@@ -463,11 +469,53 @@ namespace build2
     return nullptr;
   }
 
+  // Record a span for the target in the build timeline, if enabled. The
+  // rule, if known, is recorded as the span argument.
+  //
+  class target_span
+  {
+  public:
+    const rule_match* rule;
+
+    target_span (const char* c, const target& t, const rule_match* r)
+        : rule (r),
+          category_ (c),
+          target_ (build_timeline != nullptr ? &t : nullptr),
+          start_ (target_ != nullptr ? timeline::now () : 0) {}
+
+    ~target_span ()
+    {
+      if (target_ != nullptr)
+      {
+        uint64_t e (timeline::now ());
+
+        ostringstream os;
+        os << *target_;
+
+        timeline::arguments as;
+        if (rule != nullptr)
+          as.emplace_back ("rule", rule->first);
+
+        build_timeline->complete (category_, os.str (), start_, e, move (as));
+      }
+    }
+
+    target_span (const target_span&) = delete;
+    target_span& operator= (const target_span&) = delete;
+
+  private:
+    const char* category_;
+    const target* target_;
+    uint64_t start_;
+  };
+
   recipe
   apply_impl (action a,
               target& t,
               const pair<const string, reference_wrapper<const rule>>& r)
   {
+    target_span sp ("apply", t, &r);
+
     auto df = make_diag_frame (
       [a, &t, &r](const diag_record& dr)
       {
@@ -479,6 +527,34 @@ namespace build2
     return r.second.get ().apply (a, t);
   }
 
+  // Calculate the target's expected critical path from the durations
+  // recorded during previous builds (see opstate::priority for details).
+  //
+  // Note that the prerequisite targets should normally have been matched by
+  // now but we cannot assume this is always the case (rules are free to
+  // store whatever targets they see fit). This is why the priority is atomic
+  // and the value we read is potentially incomplete (which is harmless).
+  //
+  static void
+  match_priority (action a, target& t)
+  {
+    target::opstate& s (t[a]);
+
+    if (s.state == target_state::unchanged || t.ctx.sched.serial ())
+      return; // Noop recipe or nothing to prioritize.
+
+    uint64_t r (0);
+    for (const prerequisite_target& p: t.prerequisite_targets[a])
+    {
+      if (p.target != nullptr)
+        r = max (r, (*p.target)[a].priority.load (memory_order_relaxed));
+    }
+
+    r += t.ctx.durations.find (t);
+
+    s.priority.store (r, memory_order_relaxed);
+  }
+
   // If step is true then perform only one step of the match/apply sequence.
   //
   // If try_match is true, then indicate whether there is a rule match with
@@ -557,11 +633,15 @@ namespace build2
           // in its match() (provided that it matches) in order to, for
           // example, convey some information to apply().
           //
-          s.vars.clear ();
+          s.vars ().clear ();
           t.prerequisite_targets[a].clear ();
           if (a.inner ()) t.clear_data ();
 
-          const rule_match* r (match_impl (a, t, nullptr, try_match));
+          const rule_match* r;
+          {
+            target_span sp ("match", t, nullptr);
+            sp.rule = r = match_impl (a, t, nullptr, try_match);
+          }
 
           assert (l.offset != target::offset_tried); // Should have failed.
 
@@ -587,6 +667,10 @@ namespace build2
           //
           set_recipe (l, apply_impl (a, t, *s.rule));
           l.offset = target::offset_applied;
+
+          if (a == perform_update_id)
+            match_priority (a, t);
+
           break;
         }
       default:
@@ -598,7 +682,7 @@ namespace build2
       // As a sanity measure clear the target data since it can be incomplete
       // or invalid (mark()/unmark() should give you some ideas).
       //
-      s.vars.clear ();
+      s.vars ().clear ();
       t.prerequisite_targets[a].clear ();
       if (a.inner ()) t.clear_data ();
 
@@ -1515,7 +1599,7 @@ namespace build2
         // as a target-specific wouldn't be MT-safe). @@ Don't think this
         // applies to declared ad hoc members.
         //
-        lookup l (mt->state[a].vars[t.ctx.var_backlink]);
+        lookup l (mt->state[a].vars ()[t.ctx.var_backlink]);
 
         optional<mode> bm (l ? backlink_test (*mt, l) : m);
 
@@ -1578,6 +1662,65 @@ namespace build2
     }
   }
 
+  static inline uint64_t
+  now ()
+  {
+    using namespace chrono;
+
+    return static_cast<uint64_t> (
+      duration_cast<nanoseconds> (
+        steady_clock::now ().time_since_epoch ()).count ());
+  }
+
+  // Update the target's execution timing information (see opstate::finished
+  // for details) and record its execution for the critical path calculation
+  // and, if this is update, its duration for the subsequent builds.
+  //
+  // The recipe execution time normally includes waiting for the
+  // prerequisites so we only count from the point when the last of them has
+  // finished. We only consider prerequisites that have been executed which
+  // is both an approximation (a recipe may execute targets that are not in
+  // prerequisite_targets) and a requirement since otherwise we could be
+  // racing with the thread that is executing them.
+  //
+  static void
+  execute_timing (action a, target& t, uint64_t start, uint64_t end)
+  {
+    context& ctx (t.ctx);
+    target::opstate& s (t[a]);
+
+    size_t exec (ctx.count_executed ());
+
+    uint64_t b (start);
+
+    for (const prerequisite_target& p: t.prerequisite_targets[a])
+    {
+      const target* pt (p.target);
+
+      if (pt == nullptr || pt == &t)
+        continue;
+
+      const target::opstate& ps ((*pt)[a]);
+
+      if (ps.task_count.load (memory_order_acquire) != exec)
+        continue;
+
+      b = max (b, ps.finished);
+    }
+
+    uint64_t d (end > b ? end - b : 0);
+
+    s.finished = end;
+
+    if (a.inner ())
+      ctx.durations.record (t,
+                            end,
+                            d,
+                            (a == perform_update_id           &&
+                             s.state == target_state::changed &&
+                             !ctx.dry_run));
+  }
+
   static target_state
   execute_impl (action a, target& t)
   {
@@ -1588,9 +1731,13 @@ namespace build2
     assert (s.task_count.load (memory_order_consume) == t.ctx.count_busy ()
             && s.state == target_state::unknown);
 
+    uint64_t start (now ());
+
     target_state ts;
     try
     {
+      target_span sp ("execute", t, s.rule);
+
       // Handle target backlinking to forwarded configurations.
       //
       // Note that this function will never be called if the recipe is noop
@@ -1624,6 +1771,8 @@ namespace build2
       ts = s.state = target_state::failed;
     }
 
+    execute_timing (a, t, start, now ());
+
     // Decrement the target count (see set_recipe() for details).
     //
     if (a.inner ())
@@ -1808,6 +1957,51 @@ namespace build2
       pt.target = nullptr;
   }
 
+  // Determine the order in which to start executing the targets in the
+  // [b, e) range. If none of them have the priority (see opstate::priority
+  // for details), then leave the result empty, meaning the original order.
+  // Otherwise, order them so that the targets with the longest expected
+  // critical path are started first.
+  //
+  // Note that the tasks we queue first are also the first to be picked up by
+  // the helper threads (while this thread works through its queue from the
+  // other end) so this way they get started as soon as possible rather than
+  // being stuck behind a bunch of shorter tasks.
+  //
+  using execute_order = small_vector<size_t, 16>;
+
+  template <typename T>
+  static void
+  order_execute (context& ctx, action a,
+                 T ts[], size_t b, size_t e,
+                 execute_order& r)
+  {
+    if (e - b < 2 || ctx.sched.serial ())
+      return;
+
+    auto priority = [a, ts] (size_t i) -> uint64_t
+    {
+      const target* t (ts[i]);
+      return t != nullptr ? (*t)[a].priority.load (memory_order_relaxed) : 0;
+    };
+
+    size_t i (b);
+    for (; i != e && priority (i) == 0; ++i) ;
+
+    if (i == e)
+      return;
+
+    r.reserve (e - b);
+    for (i = b; i != e; ++i)
+      r.push_back (i);
+
+    stable_sort (r.begin (), r.end (),
+                 [&priority] (size_t x, size_t y)
+                 {
+                   return priority (x) > priority (y);
+                 });
+  }
+
   template <typename T>
   target_state
   straight_execute_members (context& ctx, action a, atomic_count& tc,
@@ -1823,9 +2017,13 @@ namespace build2
     wait_guard wg (ctx, busy, tc);
 
     n += p;
-    for (size_t i (p); i != n; ++i)
+
+    execute_order o;
+    order_execute (ctx, a, ts, p, n, o);
+
+    for (size_t j (p); j != n; ++j)
     {
-      const target*& mt (ts[i]);
+      const target*& mt (ts[o.empty () ? j : o[j - p]]);
 
       if (mt == nullptr) // Skipped.
         continue;
@@ -1960,9 +2158,12 @@ namespace build2
 
     wait_guard wg (ctx, busy, t[a].task_count);
 
-    for (size_t i (0); i != n; ++i)
+    execute_order o;
+    order_execute (ctx, a, pts.data (), 0, n, o);
+
+    for (size_t j (0); j != n; ++j)
     {
-      const target*& pt (pts[i]);
+      const target*& pt (pts[o.empty () ? j : o[j]]);
 
       if (pt == nullptr) // Skipped.
         continue;
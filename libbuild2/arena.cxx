@@ -0,0 +1,117 @@
+// file      : libbuild2/arena.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/arena.hxx>
+
+using namespace std;
+
+namespace build2
+{
+  static atomic<uint64_t> arena_ids (0);
+
+  // TLS cache of the thread's cursor in an arena. Note that we identify the
+  // arena by its id rather than address since a new arena (for example, in
+  // the next build context) may end up at the same address.
+  //
+  static
+#ifdef __cpp_thread_local
+  thread_local
+#else
+  __thread
+#endif
+  uint64_t arena_id = 0;
+
+  static
+#ifdef __cpp_thread_local
+  thread_local
+#else
+  __thread
+#endif
+  void* arena_cursor = nullptr;
+
+  static inline char*
+  align_up (char* p, size_t a)
+  {
+    uintptr_t v (reinterpret_cast<uintptr_t> (p));
+    return reinterpret_cast<char*> ((v + a - 1) & ~(uintptr_t (a) - 1));
+  }
+
+  arena::
+  arena (size_t bs)
+      : id_ (arena_ids.fetch_add (1, memory_order_relaxed) + 1),
+        block_size_ (bs)
+  {
+  }
+
+  arena::cursor& arena::
+  local ()
+  {
+    // A thread may go back and forth between several arenas (for example,
+    // of the module building context) so we keep its cursor in each.
+    //
+    if (arena_id != id_)
+    {
+      mlock l (mutex_);
+
+      arena_cursor = &cursors_[this_thread::get_id ()];
+      arena_id = id_;
+    }
+
+    return *static_cast<cursor*> (arena_cursor);
+  }
+
+  void* arena::
+  allocate (size_t n, size_t a)
+  {
+    cursor& c (local ());
+
+    if (c.next != nullptr)
+    {
+      char* p (align_up (c.next, a));
+
+      if (p <= c.end && static_cast<size_t> (c.end - p) >= n)
+      {
+        c.next = p + n;
+        return p;
+      }
+    }
+
+    return allocate_block (c, n, a);
+  }
+
+  void* arena::
+  allocate_block (cursor& c, size_t n, size_t a)
+  {
+    // Give an object that would take up a significant part of a block its
+    // own block and keep allocating from the current one.
+    //
+    bool own (n + a > block_size_ / 4);
+    size_t bs (own ? n + a : block_size_);
+
+    unique_ptr<char[]> b (new char[bs]);
+    char* s (b.get ());
+
+    {
+      mlock l (mutex_);
+      blocks_.push_back (move (b));
+      allocated_ += bs;
+    }
+
+    char* p (align_up (s, a));
+
+    if (!own)
+    {
+      c.next = p + n;
+      c.end = s + bs;
+    }
+
+    return p;
+  }
+
+  size_t arena::
+  allocated () const
+  {
+    mlock l (mutex_);
+    return allocated_;
+  }
+}
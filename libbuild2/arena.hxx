@@ -0,0 +1,70 @@
+// file      : libbuild2/arena.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_ARENA_HXX
+#define LIBBUILD2_ARENA_HXX
+
+#include <map>
+#include <cstddef> // max_align_t
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/export.hxx>
+
+namespace build2
+{
+  // Memory arena for objects that live as long as the build context (for
+  // example, targets).
+  //
+  // Allocation is done by bumping a pointer in a block that belongs to the
+  // calling thread so that threads allocating concurrently don't contend
+  // (other than when a thread needs a new block) and objects allocated by
+  // the same thread (for example, a target and its prerequisite targets
+  // entered by search()) end up close to each other. Deallocation is a
+  // no-op: all the memory is released when the arena is destroyed.
+  //
+  class LIBBUILD2_SYMEXPORT arena
+  {
+  public:
+    void*
+    allocate (size_t size, size_t align = alignof (std::max_align_t));
+
+    // Return the total number of bytes in the blocks allocated by the
+    // arena.
+    //
+    size_t
+    allocated () const;
+
+    explicit
+    arena (size_t block_size = 64 * 1024);
+
+    arena (const arena&) = delete;
+    arena& operator= (const arena&) = delete;
+
+  private:
+    // The allocation position of a thread in its current block.
+    //
+    struct cursor
+    {
+      char* next = nullptr;
+      char* end  = nullptr;
+    };
+
+    cursor&
+    local ();
+
+    void*
+    allocate_block (cursor&, size_t size, size_t align);
+
+    uint64_t id_; // Unique among all the arenas ever created.
+    size_t block_size_;
+
+    mutable mutex mutex_;
+    vector<unique_ptr<char[]>> blocks_;
+    std::map<thread::id, cursor> cursors_;
+    size_t allocated_ = 0;
+  };
+}
+
+#endif // LIBBUILD2_ARENA_HXX
@@ -92,7 +92,7 @@ namespace build2
     {
       const G* g (ctx.targets.find<G> (dir, out, n));
 
-      M* m (new M (ctx, move (dir), move (out), move (n)));
+      M* m (new (ctx) M (ctx, move (dir), move (out), move (n)));
       m->group = g;
 
       return m;
@@ -273,7 +273,7 @@ namespace build2
             ? const_cast<S*> (ctx.targets.find<S> (dir, out, n))
             : nullptr);
 
-      G* g (new G (ctx, move (dir), move (out), move (n)));
+      G* g (new (ctx) G (ctx, move (dir), move (out), move (n)));
 
       if (e != nullptr) e->group = g;
       if (a != nullptr) a->group = g;
@@ -334,7 +334,7 @@ namespace build2
                 ? const_cast<libus*> (ctx.targets.find<libus> (dir, out, n))
                 : nullptr);
 
-      libul* g (new libul (ctx, move (dir), move (out), move (n)));
+      libul* g (new (ctx) libul (ctx, move (dir), move (out), move (n)));
 
       if (a != nullptr) a->group = g;
       if (s != nullptr) s->group = g;
@@ -417,7 +417,7 @@ namespace build2
                ? const_cast<libs*> (ctx.targets.find<libs> (dir, out, n))
                : nullptr);
 
-      lib* l (new lib (ctx, move (dir), move (out), move (n)));
+      lib* l (new (ctx) lib (ctx, move (dir), move (out), move (n)));
 
       if (a != nullptr) a->group = l;
       if (s != nullptr) s->group = l;
@@ -3506,6 +3506,7 @@ namespace build2
             if (verb >= 3)
               print_process (args.data ()); // Disable pipe mode.
 
+            process_span pspan (args);
             process pr;
 
             try
@@ -4332,6 +4333,7 @@ namespace build2
         if (ps)
           psrc.active = false;
 
+        process_span pspan (args);
         process pr;
 
         try
@@ -4986,7 +4988,7 @@ namespace build2
               if (bt->is_a<bmix> ())
               {
                 const string& n (
-                  cast<string> (bt->state[a].vars[c_module_name]));
+                  cast<string> (bt->state[a].vars ()[c_module_name]));
 
                 if (const target** p = check_exact (n))
                   *p = bt;
@@ -5163,7 +5165,8 @@ namespace build2
 
         if (m.score <= match_max (in))
         {
-          const string& mn (cast<string> (bt->state[a].vars[c_module_name]));
+          const string& mn (
+            cast<string> (bt->state[a].vars ()[c_module_name]));
 
           if (in != mn)
           {
@@ -5207,7 +5210,8 @@ namespace build2
             if (et == nullptr)
               continue; // Unresolved (std.*).
 
-            const string& mn (cast<string> (et->state[a].vars[c_module_name]));
+            const string& mn (
+              cast<string> (et->state[a].vars ()[c_module_name]));
 
             if (find_if (imports.begin (), imports.end (),
                          [&mn] (const module_import& i)
@@ -5652,7 +5656,7 @@ namespace build2
             else
             {
               s.insert (0, 1, '=');
-              s.insert (0, cast<string> (f.state[a].vars[c_module_name]));
+              s.insert (0, cast<string> (f.state[a].vars ()[c_module_name]));
               s.insert (0, "-fmodule-file=");
             }
 
@@ -5685,7 +5689,7 @@ namespace build2
             // specified with the IFCPATH environment variable or the
             // /module:stdIfcDir option.
             //
-            if (std_module (cast<string> (f.state[a].vars[c_module_name])))
+            if (std_module (cast<string> (f.state[a].vars ()[c_module_name])))
             {
               dir_path d (f.path ().directory ());
 
@@ -6224,6 +6228,7 @@ namespace build2
           //
           bool filter (ctype == compiler_type::msvc);
 
+          process_span pspan (args);
           process pr (cpath,
                       args.data (),
                       0, (filter ? -1 : 2), 2,
@@ -6300,6 +6305,7 @@ namespace build2
 
           try
           {
+            process_span pspan (args);
             process pr (cpath,
                         args.data (),
                         0, 2, 2,
@@ -123,6 +123,7 @@ namespace build2
 
         // Open pipe to stderr, redirect stdin and stdout to /dev/null.
         //
+        process_span ps (args);
         process pr (xc,
                     args.data (),
                     -2,     /* stdin */
@@ -273,6 +274,7 @@ namespace build2
 
       // Open pipe to stdout.
       //
+      process_span ps (args);
       process pr (run_start (env,
                              args,
                              0, /* stdin */
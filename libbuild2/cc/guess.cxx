@@ -182,6 +182,7 @@ namespace build2
       // could also be because there is something wrong with the compiler or
       // options but that we simply leave to blow up later).
       //
+      process_span ps (args);
       process pr (run_start (3     /* verbosity */,
                              xp,
                              args,
@@ -1949,6 +1950,7 @@ namespace build2
       // The diagnostics we are interested in goes to stderr but we also get a
       // few lines of the preprocessed boilerplate at the end.
       //
+      process_span ps (args);
       process pr (run_start (3     /* verbosity */,
                              xp,
                              args,
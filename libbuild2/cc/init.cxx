@@ -140,6 +140,10 @@ namespace build2
       vp.insert<bool> ("config.cc.reprocess");
       vp.insert<bool> ("cc.reprocess");
 
+      // Maximum number of concurrent links (see the cc.link resource pool).
+      //
+      vp.insert<uint64_t> ("config.cc.link_jobs");
+
       // Register scope operation callback.
       //
       // It feels natural to do clean up sidebuilds as a post operation but
@@ -279,6 +283,17 @@ namespace build2
       if (lookup l = lookup_config (rs, "config.cc.reprocess"))
         rs.assign ("cc.reprocess") = *l;
 
+      // config.cc.link_jobs
+      //
+      // Note that the resource pool is shared by all the projects in this
+      // build context.
+      //
+      if (lookup l = lookup_config (rs, "config.cc.link_jobs"))
+      {
+        if (uint64_t n = cast<uint64_t> (l))
+          rs.ctx.resource_pools.insert ("cc.link", static_cast<size_t> (n));
+      }
+
       // Load the bin.config module.
       //
       if (!cast_false<bool> (rs["bin.config.loaded"]))
@@ -35,6 +35,17 @@ namespace build2
   {
     using namespace bin;
 
+    // Variables looked up for every target and prerequisite (see
+    // builtin_variable for details).
+    //
+    static const builtin_variable var_bin_whole ("bin.whole");
+    static const builtin_variable var_bin_rpath ("bin.rpath");
+    static const builtin_variable var_bin_rpath_link ("bin.rpath_link");
+    static const builtin_variable var_bin_rpath_auto ("bin.rpath.auto");
+    static const builtin_variable var_bin_lib_version ("bin.lib.version");
+    static const builtin_variable var_bin_lib_load_suffix (
+      "bin.lib.load_suffix");
+
     link_rule::
     link_rule (data&& d)
         : common (move (d)),
@@ -323,14 +334,14 @@ namespace build2
 
       // See if we have the load suffix.
       //
-      const string& ls (cast_empty<string> (t["bin.lib.load_suffix"]));
+      const string& ls (cast_empty<string> (t[var_bin_lib_load_suffix]));
 
       // Figure out the version.
       //
       string ver;
       bool verp (true); // Platform-specific.
       using verion_map = map<string, string>;
-      if (const verion_map* m = cast_null<verion_map> (t["bin.lib.version"]))
+      if (const verion_map* m = cast_null<verion_map> (t[var_bin_lib_version]))
       {
         // First look for the target system.
         //
@@ -1323,7 +1334,9 @@ namespace build2
           bool u;
           if ((u = pt->is_a<libux> ()) || pt->is_a<liba> ())
           {
-            const variable& var (ctx.var_pool["bin.whole"]); // @@ Cache.
+            const variable* pv (ctx.find_variable (var_bin_whole));
+            assert (pv != nullptr);
+            const variable& var (*pv);
 
             // See the bin module for the lookup semantics discussion. Note
             // that the variable is not overridable so we omit find_override()
@@ -2091,7 +2104,7 @@ namespace build2
         // assembly itself is generated later, after updating the target. Omit
         // it if we are updating for install.
         //
-        if (!for_install && cast_true<bool> (t["bin.rpath.auto"]))
+        if (!for_install && cast_true<bool> (t[var_bin_rpath_auto]))
           rpath_timestamp = windows_rpath_timestamp (t, bs, a, li);
 
         auto p (windows_manifest (t, rpath_timestamp != timestamp_nonexistent));
@@ -2130,6 +2143,7 @@ namespace build2
 
               try
               {
+                process_span ps (args);
                 process pr (rc,
                             args,
                             -1      /* stdin  */,
@@ -2380,10 +2394,10 @@ namespace build2
           //
           lookup l;
 
-          if ((l = t["bin.rpath"]) && !l->empty ())
+          if ((l = t[var_bin_rpath]) && !l->empty ())
             fail << ctgt << " does not support rpath";
 
-          if ((l = t["bin.rpath_link"]) && !l->empty ())
+          if ((l = t[var_bin_rpath_link]) && !l->empty ())
             fail << ctgt << " does not support rpath-link";
         }
         else
@@ -2435,11 +2449,11 @@ namespace build2
 
           lookup l;
 
-          if ((l = t["bin.rpath"]) && !l->empty ())
+          if ((l = t[var_bin_rpath]) && !l->empty ())
             for (const dir_path& p: cast<dir_paths> (l))
               sargs.push_back ("-Wl,-rpath," + p.string ());
 
-          if ((l = t["bin.rpath_link"]) && !l->empty ())
+          if ((l = t[var_bin_rpath_link]) && !l->empty ())
           {
             // Only certain targets support -rpath-link (Linux, *BSD).
             //
@@ -3146,6 +3160,17 @@ namespace build2
                        !lt.static_library () &&
                        cast<string> (rs["bin.ld.id"]) != "msvc-lld");
 
+          // Limit the number of concurrent links if requested (see
+          // config.cc.link_jobs). Archiving is cheap so we don't bother.
+          //
+          resource_guard rg;
+          if (!lt.static_library ())
+          {
+            if (resource_pool* p = ctx.resource_pools.find ("cc.link"))
+              rg = resource_guard (*p);
+          }
+
+          process_span ps (args);
           process pr (*ld,
                       args.data (),
                       0                  /* stdin  */,
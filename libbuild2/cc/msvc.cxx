@@ -381,6 +381,7 @@ namespace build2
       // Link.exe seem to always dump everything to stdout but just in case
       // redirect stderr to stdout.
       //
+      process_span ps (args);
       process pr (run_start (ld,
                              args,
                              0     /* stdin */,
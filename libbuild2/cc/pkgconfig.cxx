@@ -1618,7 +1618,7 @@ namespace build2
 
               modules.push_back (
                 module {
-                  cast<string> (pt->state[a].vars[c_module_name]),
+                  cast<string> (pt->state[a].vars ()[c_module_name]),
                   move (p),
                   move (pp),
                   symexport
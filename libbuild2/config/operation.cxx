@@ -902,6 +902,7 @@ namespace build2
         l5 ([&]{trace << "completely disfiguring " << out_root;});
 
         r = rmfile (ctx, config_file (rs)) || r;
+        r = rmfile (ctx, durations_file (rs), 2) || r;
 
         if (out_root != src_root)
         {
@@ -11,6 +11,7 @@
 #include <libbuild2/target.hxx>
 #include <libbuild2/variable.hxx>
 #include <libbuild2/function.hxx>
+#include <libbuild2/timeline.hxx>
 #include <libbuild2/diagnostics.hxx>
 
 #include <libbutl/ft/exception.hxx> // uncaught_exceptions
@@ -42,6 +43,12 @@ namespace build2
 
   struct context::data
   {
+    // Note: must be destroyed after everything allocated in it.
+    //
+    arena target_arena;
+    intern_pool<dir_path> target_dirs;
+    intern_pool<string> target_names;
+
     scope_map scopes;
     target_set targets;
     variable_pool var_pool;
@@ -52,7 +59,24 @@ namespace build2
     variable_override_cache global_override_cache;
     strings global_var_overrides;
 
-    data (context& c): scopes (c), targets (c), var_pool (&c /* global */) {}
+    // Builtin variable slots (see find_variable()). Note that builtin
+    // variables declared after the context has been created (for example,
+    // in a dynamically-loaded module) have no slots.
+    //
+    size_t builtin_variables_size;
+    unique_ptr<atomic<const variable*>[]> builtin_variables;
+
+    data (context& c)
+        : scopes (c),
+          targets (c),
+          var_pool (&c /* global */),
+          builtin_variables_size (builtin_variable::count ()),
+          builtin_variables (
+            new atomic<const variable*>[builtin_variables_size])
+    {
+      for (size_t i (0); i != builtin_variables_size; ++i)
+        builtin_variables[i].store (nullptr, memory_order_relaxed);
+    }
   };
 
   context::
@@ -73,6 +97,9 @@ namespace build2
         phase_mutex (*this),
         scopes (data_->scopes),
         targets (data_->targets),
+        target_arena (data_->target_arena),
+        target_dirs (data_->target_dirs),
+        target_names (data_->target_names),
         var_pool (data_->var_pool),
         var_overrides (data_->var_overrides),
         functions (data_->functions),
@@ -80,6 +107,7 @@ namespace build2
         global_target_types (data_->global_target_types),
         global_override_cache (data_->global_override_cache),
         global_var_overrides (data_->global_var_overrides),
+        resource_pools (s),
         modules_lock (ml),
         module_context (mc ? *mc : nullptr),
         module_context_storage (mc
@@ -575,6 +603,104 @@ namespace build2
     }
   }
 
+  // resource_pool
+  //
+  size_t resource_pool::
+  acquire (size_t w)
+  {
+    if (w > capacity_)
+      w = capacity_;
+
+    {
+      mlock l (mutex_);
+
+      if (used_ + w <= capacity_)
+      {
+        used_ += w;
+        return w;
+      }
+    }
+
+    // Note that the capacity will be released by another scheduler thread
+    // so this is not an external wait.
+    //
+    sched_.deactivate (false /* external */);
+    {
+      mlock l (mutex_);
+
+      while (used_ + w > capacity_)
+        condv_.wait (l);
+
+      used_ += w;
+    }
+
+    try
+    {
+      sched_.activate (false /* external */);
+    }
+    catch (...)
+    {
+      release (w);
+      throw;
+    }
+
+    return w;
+  }
+
+  void resource_pool::
+  release (size_t w)
+  {
+    {
+      mlock l (mutex_);
+      assert (used_ >= w);
+      used_ -= w;
+    }
+
+    condv_.notify_all ();
+  }
+
+  // resource_pools
+  //
+  resource_pool* resource_pools::
+  find (const string& n)
+  {
+    mlock l (mutex_);
+
+    for (auto& p: pools_)
+    {
+      if (p.first == n)
+        return p.second.get ();
+    }
+
+    return nullptr;
+  }
+
+  resource_pool& resource_pools::
+  insert (const string& n, size_t c)
+  {
+    assert (c != 0);
+
+    mlock l (mutex_);
+
+    for (auto& p: pools_)
+    {
+      if (p.first == n)
+      {
+        resource_pool& r (*p.second);
+
+        if (c < r.capacity_)
+          r.capacity_ = c;
+
+        return r;
+      }
+    }
+
+    pools_.emplace_back (n, unique_ptr<resource_pool> (
+                           new resource_pool (sched_, c)));
+
+    return *pools_.back ().second;
+  }
+
   context::
   ~context ()
   {
@@ -613,6 +739,63 @@ namespace build2
     skip_count.store (0, memory_order_relaxed);
   }
 
+  const variable* context::
+  find_variable (const builtin_variable& bv) const
+  {
+    if (bv.id >= data_->builtin_variables_size)
+      return var_pool.find (bv.name);
+
+    atomic<const variable*>& s (data_->builtin_variables[bv.id]);
+
+    const variable* r (s.load (memory_order_acquire));
+    if (r == nullptr)
+    {
+      // Note that the pool is only modified during the (exclusive) load
+      // phase so it is safe to look it up here. Also, we don't cache the
+      // absence of the variable since it can be entered later.
+      //
+      if ((r = var_pool.find (bv.name)) != nullptr)
+        s.store (r, memory_order_release);
+    }
+
+    return r;
+  }
+
+  // Switch the context to the new phase recording this in the build
+  // timeline, if enabled.
+  //
+  static inline void
+  switch_phase (context& ctx, run_phase p)
+  {
+    if (build_timeline != nullptr && ctx.phase != p)
+    {
+      ostringstream os;
+      os << p;
+      build_timeline->instant ("phase", os.str (), timeline::now ());
+    }
+
+    ctx.phase = p;
+  }
+
+  // Wait for the phase switch recording the time spent blocked in the build
+  // timeline, if enabled.
+  //
+  static inline void
+  wait_phase (context& ctx, run_phase p,
+              condition_variable& v, mlock& l)
+  {
+    uint64_t ts (build_timeline != nullptr ? timeline::now () : 0);
+
+    for (; ctx.phase != p; v.wait (l)) ;
+
+    if (ts != 0)
+    {
+      ostringstream os;
+      os << "wait for " << p;
+      build_timeline->complete ("phase", os.str (), ts, timeline::now ());
+    }
+  }
+
   bool run_phase_mutex::
   lock (run_phase p)
   {
@@ -638,13 +821,13 @@ namespace build2
       //
       if (u)
       {
-        ctx_.phase = p;
+        switch_phase (ctx_, p);
         r = !fail_;
       }
       else if (ctx_.phase != p)
       {
         ctx_.sched.deactivate (false /* external */);
-        for (; ctx_.phase != p; v->wait (l)) ;
+        wait_phase (ctx_, p, *v, l);
         r = !fail_;
         l.unlock (); // Important: activate() can block.
         ctx_.sched.activate (false /* external */);
@@ -693,10 +876,14 @@ namespace build2
       {
         condition_variable* v;
 
-        if      (lc_ != 0) {ctx_.phase = run_phase::load;    v = &lv_;}
-        else if (mc_ != 0) {ctx_.phase = run_phase::match;   v = &mv_;}
-        else if (ec_ != 0) {ctx_.phase = run_phase::execute; v = &ev_;}
-        else               {ctx_.phase = run_phase::load;    v = nullptr;}
+        run_phase n;
+
+        if      (lc_ != 0) {n = run_phase::load;    v = &lv_;}
+        else if (mc_ != 0) {n = run_phase::match;   v = &mv_;}
+        else if (ec_ != 0) {n = run_phase::execute; v = &ev_;}
+        else               {n = run_phase::load;    v = nullptr;}
+
+        switch_phase (ctx_, n);
 
         if (v != nullptr)
         {
@@ -743,7 +930,7 @@ namespace build2
 
       if (u)
       {
-        ctx_.phase = n;
+        switch_phase (ctx_, n);
         r = !fail_;
 
         // Notify others that could be waiting for this phase.
@@ -757,7 +944,7 @@ namespace build2
       else // phase != n
       {
         ctx_.sched.deactivate (false /* external */);
-        for (; ctx_.phase != n; v->wait (l)) ;
+        wait_phase (ctx_, n, *v, l);
         r = !fail_;
         l.unlock (); // Important: activate() can block.
         ctx_.sched.activate (false /* external */);
@@ -886,7 +1073,10 @@ namespace build2
     pl->phase = new_phase;
 
     if (new_phase == run_phase::load) // Note: load lock is exclusive.
+    {
       ctx.load_generation++;
+      ctx.filesystem_cache.clear ();
+    }
 
     //text << this_thread::get_id () << " phase switch  " << o << " " << n;
   }
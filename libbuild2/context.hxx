@@ -12,15 +12,20 @@
 //       (scope, target, variable, etc) so including any of them here is most
 //       likely a non-starter.
 //
+#include <libbuild2/arena.hxx>
+#include <libbuild2/intern.hxx>
 #include <libbuild2/action.hxx>
 #include <libbuild2/operation.hxx>
 #include <libbuild2/scheduler.hxx>
+#include <libbuild2/durations.hxx>
+#include <libbuild2/filesystem-cache.hxx>
 
 #include <libbuild2/export.hxx>
 
 namespace build2
 {
   class loaded_modules_lock;
+  class load_stat;
 
   class LIBBUILD2_SYMEXPORT run_phase_mutex
   {
@@ -98,6 +103,114 @@ namespace build2
           variable_cache (new shared_mutex[variable_cache_size]) {}
   };
 
+  // Resource pool.
+  //
+  // A pool limits the concurrency of resource-heavy operations (for example,
+  // linking with LTO which can require gigabytes of memory) independently of
+  // the overall concurrency. A pool has a capacity and each operation
+  // acquires a certain weight of it (capped at the capacity so that any
+  // operation can always be performed, if only alone). If the capacity is
+  // exhausted, then the acquiring thread is deactivated with the scheduler
+  // while waiting so that the rest of the build can proceed.
+  //
+  class LIBBUILD2_SYMEXPORT resource_pool
+  {
+  public:
+    // Return the actual (capped) weight that should be passed to release().
+    //
+    size_t
+    acquire (size_t weight = 1);
+
+    void
+    release (size_t weight = 1);
+
+    size_t
+    capacity () const {return capacity_;}
+
+    resource_pool (scheduler& s, size_t c): sched_ (s), capacity_ (c) {}
+
+  private:
+    friend class resource_pools;
+
+    scheduler& sched_;
+    size_t capacity_;
+    size_t used_ = 0;
+
+    mutex mutex_;
+    condition_variable condv_;
+  };
+
+  // Acquire the specified weight of a resource pool releasing it on
+  // destruction. The empty guard does nothing.
+  //
+  struct resource_guard
+  {
+    resource_guard (): pool (nullptr), weight (0) {}
+
+    explicit
+    resource_guard (resource_pool& p, size_t w = 1)
+        : pool (&p), weight (p.acquire (w)) {}
+
+    resource_guard (resource_guard&& x)
+        : pool (x.pool), weight (x.weight) {x.pool = nullptr;}
+
+    resource_guard&
+    operator= (resource_guard&& x)
+    {
+      if (&x != this)
+      {
+        if (pool != nullptr)
+          pool->release (weight);
+
+        pool = x.pool;
+        weight = x.weight;
+        x.pool = nullptr;
+      }
+      return *this;
+    }
+
+    ~resource_guard ()
+    {
+      if (pool != nullptr)
+        pool->release (weight);
+    }
+
+    resource_pool* pool;
+    size_t weight;
+  };
+
+  // Context-wide named resource pools.
+  //
+  // Normally a pool is created by a module during load based on the
+  // corresponding configuration variable (for example, cc.link for
+  // config.cc.link_jobs) and is then used by the rule implementations
+  // during execute. If several projects create the same pool, then the
+  // smallest capacity wins.
+  //
+  class LIBBUILD2_SYMEXPORT resource_pools
+  {
+  public:
+    // Return NULL if there is no such pool.
+    //
+    resource_pool*
+    find (const string& name);
+
+    // Create a new pool or reduce the capacity of an existing one. Should
+    // only be called during the serial load phase.
+    //
+    resource_pool&
+    insert (const string& name, size_t capacity);
+
+    explicit
+    resource_pools (scheduler& s): sched_ (s) {}
+
+  private:
+    scheduler& sched_;
+
+    mutex mutex_;
+    vector<pair<string, unique_ptr<resource_pool>>> pools_;
+  };
+
   // A build context encapsulates the state of a build. It is possible to have
   // multiple build contexts provided they are non-overlapping, that is, they
   // don't try to build the same projects (note that this is currently not
@@ -223,6 +336,12 @@ namespace build2
     run_phase phase = run_phase::load;
     size_t load_generation = 0;
 
+    // Incremented on each change to the global build state that may affect
+    // the outcome of a variable lookup (assignment in a global variable map
+    // or a new scope). Used to invalidate variable_lookup_memo entries.
+    //
+    atomic_count global_vars_version {0};
+
     // A "tri-mutex" that keeps all the threads in one of the three phases.
     // When a thread wants to switch a phase, it has to wait for all the other
     // threads to do the same (or release their phase locks). The load phase
@@ -313,6 +432,9 @@ namespace build2
     //
     const scope_map& scopes;
     target_set& targets;
+    arena& target_arena; // Target objects (see target_factory()).
+    intern_pool<dir_path>& target_dirs;  // Target dir and out.
+    intern_pool<string>& target_names;   // Target names.
     const variable_pool& var_pool;
     const variable_overrides& var_overrides; // Project and relative scope.
     function_map& functions;
@@ -419,6 +541,25 @@ namespace build2
     build2::meta_operation_table meta_operation_table;
     build2::operation_table operation_table;
 
+    // Named resource pools (see resource_pool for details).
+    //
+    build2::resource_pools resource_pools;
+
+    // Target execution durations (see durations for details).
+    //
+    build2::durations durations;
+
+    // Filesystem state observed during load (see filesystem_cache for
+    // details).
+    //
+    build2::filesystem_cache filesystem_cache;
+
+    // Load statistics or NULL if not being collected (see load_stat for
+    // details). Normally set by the driver to an object shared by all the
+    // contexts.
+    //
+    build2::load_stat* load_stat = nullptr;
+
     // The old/new src_root remapping for subprojects.
     //
     dir_path old_src_root;
@@ -462,6 +603,14 @@ namespace build2
                        const operation_info* outer = nullptr,
                        bool diag_noise = true);
 
+    // Find the pool variable corresponding to the builtin variable handle
+    // returning NULL if it has not (yet) been entered into the pool. The
+    // result is cached in a slot indexed by the builtin variable id (see
+    // builtin_variable for details).
+    //
+    const variable*
+    find_variable (const builtin_variable&) const;
+
     context (context&&) = delete;
     context& operator= (context&&) = delete;
 
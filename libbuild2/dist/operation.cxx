@@ -693,6 +693,7 @@ namespace build2
 
       // Change the archiver's working directory to dist_root.
       //
+      process_span aps (args);
       apr = run_start (app,
                        args,
                        0                 /* stdin  */,
@@ -704,6 +705,7 @@ namespace build2
       //
       if (i != 0)
       {
+        process_span cps (args.data () + i);
         cpr = run_start (cpp,
                          args.data () + i,
                          apr.in_ofd.get () /* stdin  */,
@@ -776,6 +778,7 @@ namespace build2
         // Note that to only get the archive name (without the directory) in
         // the output we have to run from the archive's directory.
         //
+        process_span ps (args);
         process pr (run_start (pp,
                                args,
                                0             /* stdin */,
@@ -217,7 +217,7 @@ namespace build2
     //
     {
       bool tv (!t.vars.empty ());
-      bool rv (a && !t.state[*a].vars.empty ());
+      bool rv (a && !t.state[*a].vars ().empty ());
 
       if (tv || rv)
       {
@@ -245,7 +245,8 @@ namespace build2
           os << endl
              << ind << '{';
           ind += "  ";
-          dump_variables (os, ind, t.state[*a].vars, s, variable_kind::rule);
+          dump_variables (
+            os, ind, t.state[*a].vars (), s, variable_kind::rule);
           ind.resize (ind.size () - 2);
           os << endl
              << ind << '}';
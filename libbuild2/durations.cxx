@@ -0,0 +1,370 @@
+// file      : libbuild2/durations.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/durations.hxx>
+
+#include <sstream>
+#include <unordered_map>
+#include <cstdlib> // strtoull()
+
+#include <libbuild2/scope.hxx>
+#include <libbuild2/target.hxx>
+#include <libbuild2/context.hxx>
+#include <libbuild2/filesystem.hxx>
+#include <libbuild2/diagnostics.hxx>
+
+using namespace std;
+using namespace butl;
+
+namespace build2
+{
+  static const path durations_file_name ("durations");
+
+  path
+  durations_file (const scope& rs)
+  {
+    return rs.out_path () / rs.root_extra->build_dir / durations_file_name;
+  }
+
+  // The number of saves after which an entry for a target that was not part
+  // of the build is dropped.
+  //
+  static const size_t max_age (16);
+
+  static atomic<uint64_t> durations_ids (0);
+
+  // TLS cache of the thread's buffer. Note that we identify the durations
+  // object by its id rather than address since a new one (for example, in
+  // the next build context) may end up at the same address.
+  //
+  static
+#ifdef __cpp_thread_local
+  thread_local
+#else
+  __thread
+#endif
+  uint64_t durations_id = 0;
+
+  static
+#ifdef __cpp_thread_local
+  thread_local
+#else
+  __thread
+#endif
+  void* durations_buffer = nullptr;
+
+  durations::
+  durations ()
+      : id_ (++durations_ids)
+  {
+  }
+
+  auto durations::
+  local () -> buffer&
+  {
+    if (durations_id != id_)
+    {
+      mlock l (mutex_);
+
+      buffers_.push_back (unique_ptr<buffer> (new buffer));
+
+      durations_id = id_;
+      durations_buffer = buffers_.back ().get ();
+    }
+
+    return *static_cast<buffer*> (durations_buffer);
+  }
+
+  // Note that we use the absolute target directory as part of the key since
+  // the durations are meaningless if the out tree is moved anyway (they will
+  // be all re-recorded on the next update).
+  //
+  static void
+  durations_key (const target& t, string& r)
+  {
+    r = t.type ().name;
+    r += '{';
+    r += t.dir.representation ();
+    r += t.name;
+    r += '}';
+
+    if (!t.out.empty ())
+    {
+      r += '@';
+      r += t.out.string ();
+    }
+  }
+
+  void durations::
+  load (const scope& rs)
+  {
+    assert (rs.ctx.phase == run_phase::load);
+
+    auto p (projects_.emplace (&rs, project ()));
+
+    if (!p.second)
+      return;
+
+    project& r (p.first->second);
+    r.file = durations_file (rs);
+
+    if (!exists (r.file))
+      return;
+
+    try
+    {
+      ifdstream ifs (r.file, ifdstream::badbit);
+
+      for (string l; !eof (getline (ifs, l)); )
+      {
+        // <duration> <age> <target>
+        //
+        char* e;
+        const char* b (l.c_str ());
+
+        uint64_t d (strtoull (b, &e, 10));
+        if (e == b || *e != ' ')
+          continue;
+
+        b = e + 1;
+        size_t a (static_cast<size_t> (strtoull (b, &e, 10)));
+        if (e == b || *e != ' ' || *++e == '\0')
+          continue;
+
+        entry& x (r.map[string (e)]);
+        x.duration = d;
+        x.age = a;
+      }
+    }
+    catch (const io_error& e)
+    {
+      tracer trace ("durations::load");
+      l5 ([&]{trace << "unable to read " << r.file << ": " << e;});
+      r.map.clear ();
+    }
+  }
+
+  uint64_t durations::
+  find (const target& t)
+  {
+    const scope* rs (t.base_scope ().root_scope ());
+
+    if (rs == nullptr)
+      return 0;
+
+    auto i (projects_.find (rs));
+    if (i == projects_.end () || i->second.map.empty ())
+      return 0;
+
+    string& k (local ().key);
+    durations_key (t, k);
+
+    auto j (i->second.map.find (k));
+    if (j == i->second.map.end ())
+      return 0;
+
+    entry& e (j->second);
+
+    if (!e.seen.load (memory_order_relaxed))
+      e.seen.store (true, memory_order_relaxed);
+
+    return e.duration;
+  }
+
+  void durations::
+  record (const target& t, uint64_t f, uint64_t d, bool s)
+  {
+    local ().executions.push_back (execution {&t, f, d, s});
+  }
+
+  void durations::
+  save ()
+  {
+    // Merge the durations recorded by this build.
+    //
+    string k;
+    for (const unique_ptr<buffer>& b: buffers_)
+    {
+      for (execution& x: b->executions)
+      {
+        if (!x.save)
+          continue;
+
+        x.save = false;
+
+        const target& t (*x.target);
+        const scope* rs (t.base_scope ().root_scope ());
+
+        if (rs == nullptr)
+          continue;
+
+        auto i (projects_.find (rs));
+        if (i == projects_.end ())
+          continue;
+
+        project& p (i->second);
+
+        durations_key (t, k);
+
+        entry& e (p.map[k]);
+        e.duration = x.duration;
+        e.seen.store (true, memory_order_relaxed);
+
+        p.dirty = true;
+      }
+    }
+
+    for (auto& pp: projects_)
+    {
+      project& p (pp.second);
+
+      if (!p.dirty)
+        continue;
+
+      p.dirty = false;
+
+      // Age the entries for the targets that were not part of this build,
+      // dropping those that got too old.
+      //
+      for (auto i (p.map.begin ()); i != p.map.end (); )
+      {
+        entry& e (i->second);
+
+        if (e.seen.load (memory_order_relaxed))
+        {
+          e.seen.store (false, memory_order_relaxed);
+          e.age = 0;
+        }
+        else if (++e.age > max_age)
+        {
+          i = p.map.erase (i);
+          continue;
+        }
+
+        ++i;
+      }
+
+      // Don't create the build/ subdirectory if it does not exist (for
+      // example, in a project that has not been configured).
+      //
+      if (!exists (p.file.directory ()))
+        continue;
+
+      // Failing to save the durations is not fatal: we will just not be as
+      // smart about the execution order in the next build.
+      //
+      try
+      {
+        ofdstream ofs (p.file);
+
+        for (const auto& e: p.map)
+          ofs << e.second.duration << ' ' << e.second.age << ' ' << e.first
+              << '\n';
+
+        ofs.close ();
+      }
+      catch (const io_error& e)
+      {
+        warn << "unable to write to " << p.file << ": " << e;
+      }
+    }
+  }
+
+  void durations::
+  executed (action a, const action_targets& ts)
+  {
+    // The executions are recorded for the inner operation (see
+    // execute_impl() for details).
+    //
+    a = a.inner_action ();
+
+    vector<execution> xs;
+    for (const unique_ptr<buffer>& b: buffers_)
+    {
+      xs.insert (xs.end (), b->executions.begin (), b->executions.end ());
+      b->executions.clear ();
+    }
+
+    if (xs.empty ())
+      return;
+
+    // Calculate the critical path leading to each target. A target can only
+    // finish after the prerequisites that it has waited for so we process
+    // them in the order of finishing.
+    //
+    sort (xs.begin (), xs.end (),
+          [] (const execution& x, const execution& y)
+          {
+            return x.finished < y.finished;
+          });
+
+    struct path_entry
+    {
+      uint64_t finished;
+      uint64_t duration;
+      uint64_t path;
+      const target* prerequisite; // Critical prerequisite.
+    };
+
+    std::unordered_map<const target*, path_entry> ps;
+    ps.reserve (xs.size ());
+
+    for (const execution& x: xs)
+    {
+      const target& t (*x.target);
+
+      uint64_t cp (0);
+      const target* c (nullptr);
+
+      for (const prerequisite_target& p: t.prerequisite_targets[a])
+      {
+        const target* pt (p.target);
+
+        if (pt == nullptr || pt == &t)
+          continue;
+
+        auto i (ps.find (pt));
+        if (i == ps.end () || i->second.finished > x.finished)
+          continue;
+
+        if (i->second.path > cp)
+        {
+          cp = i->second.path;
+          c = pt;
+        }
+      }
+
+      ps[&t] = path_entry {x.finished, x.duration, cp + x.duration, c};
+    }
+
+    const target* t (nullptr);
+    uint64_t d (0);
+    for (const action_target& at: ts)
+    {
+      const target& x (at.as<target> ());
+
+      auto i (ps.find (&x));
+      if (i != ps.end () && i->second.path > d)
+      {
+        t = &x;
+        d = i->second.path;
+      }
+    }
+
+    if (t == nullptr || d <= critical_path.duration)
+      return;
+
+    build2::critical_path r;
+    r.duration = d;
+
+    for (; t != nullptr; t = ps[t].prerequisite)
+    {
+      ostringstream os;
+      os << *t;
+
+      r.targets.emplace_back (os.str (), ps[t].duration);
+    }
+
+    critical_path = move (r);
+  }
+}
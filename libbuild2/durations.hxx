@@ -0,0 +1,155 @@
+// file      : libbuild2/durations.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_DURATIONS_HXX
+#define LIBBUILD2_DURATIONS_HXX
+
+#include <map>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/forward.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/operation.hxx> // action_targets
+
+#include <libbuild2/export.hxx>
+
+namespace build2
+{
+  // The critical path of a build, that is, the longest chain of targets each
+  // of which could only start executing once the previous one has finished.
+  // The targets are listed from the last executed to the first together with
+  // their own execution durations. All durations are in nanoseconds.
+  //
+  struct critical_path
+  {
+    uint64_t duration = 0;
+    vector<pair<string, uint64_t>> targets;
+  };
+
+  // Target execution durations recorded during previous builds.
+  //
+  // In a parallel build the overall time is bounded by the critical path and
+  // if the targets that are on it get queued behind a large number of
+  // shorter ones, then we may end up with most of the threads idling towards
+  // the end of the build. To help with this we record how long it took to
+  // update each target and use this information in subsequent builds to
+  // start executing prerequisites with the longest expected critical path
+  // first (see target::opstate::priority for details).
+  //
+  // The durations are stored per project in the durations file in the out
+  // root build/ subdirectory. Note that for an in-source build this is the
+  // source directory and so, similar to config.build, this file should be
+  // ignored by the version control system (it is removed by disfigure).
+  // Each line in this file has the following format:
+  //
+  // <duration> <age> <target>
+  //
+  // Where <duration> is in nanoseconds and <age> is the number of times the
+  // file was saved without the target's duration being looked up or
+  // recorded. Entries that get too old are dropped, which takes care of the
+  // targets that no longer exist. If the file cannot be read or is
+  // malformed, then it is silently ignored since this information only
+  // affects the execution order.
+  //
+  // The durations file is loaded when the project is loaded and since
+  // during match and execute projects can only be loaded in the exclusive
+  // load phase, the lookup does not require any locking. The durations of
+  // this build are recorded into per-thread buffers and are merged when
+  // saved.
+  //
+  class LIBBUILD2_SYMEXPORT durations
+  {
+  public:
+    // Load the durations recorded by previous builds for the project. Should
+    // be called during the load phase.
+    //
+    void
+    load (const scope& root);
+
+    // Return the duration of the target recorded by a previous build or 0 if
+    // unknown. Can be called concurrently during match and execute.
+    //
+    uint64_t
+    find (const target&);
+
+    // Record the execution of the target for the current inner action in
+    // this build: the time when it finished (steady clock) and its duration.
+    // If save is true, then also save the duration for the subsequent
+    // builds. Can be called concurrently during execute.
+    //
+    void
+    record (const target&, uint64_t finished, uint64_t duration, bool save);
+
+    // Save the durations recorded by this build for all the projects,
+    // merging them with the ones from previous builds. Should be called
+    // serially after execute.
+    //
+    void
+    save ();
+
+    // Calculate the critical path of the specified targets that have just
+    // been executed and, if it is longer than the one from previous actions,
+    // make it the critical path of this context. Then discard the recorded
+    // executions. Should be called serially after execute (and after
+    // save(), if any).
+    //
+    void
+    executed (action, const action_targets&);
+
+    build2::critical_path critical_path;
+
+    durations ();
+
+    durations (const durations&) = delete;
+    durations& operator= (const durations&) = delete;
+
+  private:
+    struct entry
+    {
+      uint64_t duration = 0;
+      size_t age = 0;
+      atomic<bool> seen {false}; // Found or recorded in this build.
+    };
+
+    struct project
+    {
+      path file;
+      bool dirty = false;
+      std::map<string, entry> map;
+    };
+
+    struct execution
+    {
+      const build2::target* target;
+      uint64_t finished;
+      uint64_t duration;
+      bool save;
+    };
+
+    struct buffer
+    {
+      vector<execution> executions;
+      string key; // Scratch space for the lookup key.
+    };
+
+    // Return this thread's buffer.
+    //
+    buffer&
+    local ();
+
+    uint64_t id_;
+
+    std::map<const scope*, project> projects_; // Keyed by root scope.
+
+    mutex mutex_;
+    vector<unique_ptr<buffer>> buffers_;
+  };
+
+  // Return the durations file path for the specified project.
+  //
+  LIBBUILD2_SYMEXPORT path
+  durations_file (const scope& root);
+}
+
+#endif // LIBBUILD2_DURATIONS_HXX
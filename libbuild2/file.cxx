@@ -9,6 +9,7 @@
 #include <libbuild2/scope.hxx>
 #include <libbuild2/target.hxx>
 #include <libbuild2/context.hxx>
+#include <libbuild2/load-stat.hxx>
 #include <libbuild2/filesystem.hxx>
 #include <libbuild2/diagnostics.hxx>
 #include <libbuild2/prerequisite-key.hxx>
@@ -77,12 +78,29 @@ namespace build2
     return os;
   }
 
+  // Check if the file/directory exists. If the context is specified and we
+  // are loading, then use (and populate) the context's filesystem cache.
+  // During bootstrap and project discovery the same files (bootstrap.build,
+  // src-root.build, etc) are probed for repeatedly (for the amalgamation,
+  // each subproject, each import, etc) and the alternative naming scheme
+  // doubles the number of such probes.
+  //
+  template <typename T>
+  static inline bool
+  probe (context* ctx, const T& p)
+  {
+    return ctx != nullptr && ctx->phase == run_phase::load
+      ? ctx->filesystem_cache.exists (p)
+      : exists (p);
+  }
+
   // Check if the standard/alternative file/directory exists, returning empty
   // path if it does not.
   //
   template <typename T>
   static T
-  exists (const dir_path& d, const T& s, const T& a, optional<bool>& altn)
+  exists (context* ctx,
+          const dir_path& d, const T& s, const T& a, optional<bool>& altn)
   {
     T p;
     bool e;
@@ -90,7 +108,7 @@ namespace build2
     if (altn)
     {
       p = d / (*altn ? a : s);
-      e = exists (p);
+      e = probe (ctx, p);
     }
     else
     {
@@ -98,13 +116,13 @@ namespace build2
       //
       p = d / a;
 
-      if ((e = exists (p)))
+      if ((e = probe (ctx, p)))
         altn = true;
       else
       {
         p = d / s;
 
-        if ((e = exists (p)))
+        if ((e = probe (ctx, p)))
           altn = false;
       }
     }
@@ -112,49 +130,87 @@ namespace build2
     return e ? p : T ();
   }
 
-  bool
-  is_src_root (const dir_path& d, optional<bool>& altn)
+  static bool
+  is_src_root (context* ctx, const dir_path& d, optional<bool>& altn)
   {
     // We can't have root without bootstrap.build.
     //
-    return !exists (d, std_bootstrap_file, alt_bootstrap_file, altn).empty ();
+    return !exists (
+      ctx, d, std_bootstrap_file, alt_bootstrap_file, altn).empty ();
   }
 
-  bool
-  is_out_root (const dir_path& d, optional<bool>& altn)
+  static bool
+  is_out_root (context* ctx, const dir_path& d, optional<bool>& altn)
   {
-    return !exists (d, std_src_root_file, alt_src_root_file, altn).empty ();
+    return !exists (
+      ctx, d, std_src_root_file, alt_src_root_file, altn).empty ();
   }
 
-  dir_path
-  find_src_root (const dir_path& b, optional<bool>& altn)
+  static dir_path
+  find_src_root (context* ctx, const dir_path& b, optional<bool>& altn)
   {
     assert (b.absolute ());
 
     for (dir_path d (b); !d.root () && d != home; d = d.directory ())
     {
-      if (is_src_root (d, altn))
+      if (is_src_root (ctx, d, altn))
         return d;
     }
 
     return dir_path ();
   }
 
-  pair<dir_path, bool>
-  find_out_root (const dir_path& b, optional<bool>& altn)
+  static pair<dir_path, bool>
+  find_out_root (context* ctx, const dir_path& b, optional<bool>& altn)
   {
     assert (b.absolute ());
 
     for (dir_path d (b); !d.root () && d != home; d = d.directory ())
     {
       bool s;
-      if ((s = is_src_root (d, altn)) || is_out_root (d, altn))
+      if ((s = is_src_root (ctx, d, altn)) || is_out_root (ctx, d, altn))
         return make_pair (move (d), s);
     }
 
     return make_pair (dir_path (), false);
   }
 
+  bool
+  is_src_root (const dir_path& d, optional<bool>& altn)
+  {
+    return is_src_root (nullptr, d, altn);
+  }
+
+  bool
+  is_out_root (const dir_path& d, optional<bool>& altn)
+  {
+    return is_out_root (nullptr, d, altn);
+  }
+
+  dir_path
+  find_src_root (const dir_path& b, optional<bool>& altn)
+  {
+    return find_src_root (nullptr, b, altn);
+  }
+
+  dir_path
+  find_src_root (context& ctx, const dir_path& b, optional<bool>& altn)
+  {
+    return find_src_root (&ctx, b, altn);
+  }
+
+  pair<dir_path, bool>
+  find_out_root (const dir_path& b, optional<bool>& altn)
+  {
+    return find_out_root (nullptr, b, altn);
+  }
+
+  pair<dir_path, bool>
+  find_out_root (context& ctx, const dir_path& b, optional<bool>& altn)
+  {
+    return find_out_root (&ctx, b, altn);
+  }
+
   // Remap the src_root variable value if it is inside old_src_root.
   //
   static inline void
@@ -465,7 +521,8 @@ namespace build2
   dir_path
   bootstrap_fwd (context& ctx, const dir_path& src_root, optional<bool>& altn)
   {
-    path f (exists (src_root, std_out_root_file, alt_out_root_file, altn));
+    path f (
+      exists (&ctx, src_root, std_out_root_file, alt_out_root_file, altn));
 
     if (f.empty ())
       return src_root;
@@ -531,7 +588,8 @@ namespace build2
     context& ctx (root.ctx);
     const dir_path& out_root (root.out_path ());
 
-    path f (exists (out_root, std_src_root_file, alt_src_root_file, altn));
+    path f (
+      exists (&ctx, out_root, std_src_root_file, alt_src_root_file, altn));
 
     if (!f.empty ())
     {
@@ -669,11 +727,12 @@ namespace build2
 
     if (src_root == nullptr)
     {
-      if (out_src ? *out_src : is_src_root (out_root, altn))
+      if (out_src ? *out_src : is_src_root (&ctx, out_root, altn))
         src_root = &out_root;
       else
       {
-        path f (exists (out_root, std_src_root_file, alt_src_root_file, altn));
+        path f (
+          exists (&ctx, out_root, std_src_root_file, alt_src_root_file, altn));
 
         if (f.empty ())
         {
@@ -707,7 +766,10 @@ namespace build2
 
     project_name name;
     {
-      path f (exists (*src_root, std_bootstrap_file, alt_bootstrap_file, altn));
+      path f (exists (&ctx,
+                      *src_root,
+                      std_bootstrap_file, alt_bootstrap_file,
+                      altn));
 
       if (f.empty ())
         fail << "no build/bootstrap.build in " << *src_root;
@@ -750,8 +812,8 @@ namespace build2
         bool src (false);
         optional<bool> altn;
 
-        if (!((out && is_out_root (sd, altn)) ||
-              (src =  is_src_root (sd, altn))))
+        if (!((out && is_out_root (&ctx, sd, altn)) ||
+              (src =  is_src_root (&ctx, sd, altn))))
         {
           // We used to scan for subproject recursively but this is probably
           // too loose (think of some tests laying around). In the future we
@@ -823,7 +885,8 @@ namespace build2
     const dir_path& src_root (rs.src_path ());
 
     {
-      path f (exists (src_root, std_bootstrap_file, alt_bootstrap_file, altn));
+      path f (
+        exists (&ctx, src_root, std_bootstrap_file, alt_bootstrap_file, altn));
 
       if (rs.root_extra == nullptr)
       {
@@ -952,7 +1015,7 @@ namespace build2
         //
         subprojects sps;
 
-        if (exists (out_root))
+        if (probe (&ctx, out_root))
         {
           l5 ([&]{trace << "looking for subprojects in " << out_root;});
           find_subprojects (rs.ctx, sps, out_root, out_root, true);
@@ -1070,7 +1133,8 @@ namespace build2
     // always tighten the test by also looking for a hook file with the
     // correct extension.
     //
-    dir_path d (exists (out_root, std_bootstrap_dir, alt_bootstrap_dir, altn));
+    dir_path d (exists (&root.ctx,
+                        out_root, std_bootstrap_dir, alt_bootstrap_dir, altn));
 
     if (!d.empty ())
     {
@@ -1089,7 +1153,7 @@ namespace build2
 
     dir_path d (out_root / root.root_extra->bootstrap_dir);
 
-    if (exists (d))
+    if (probe (&root.ctx, d))
     {
       parser p (root.ctx, load_stage::boot);
       source_hooks (p, root, d, false /* pre */);
@@ -1286,6 +1350,11 @@ namespace build2
     if (scope* rs = root.parent_scope ()->root_scope ())
       load_root (*rs);
 
+    // Load the target durations recorded by previous builds (see durations
+    // for details).
+    //
+    root.ctx.durations.load (root);
+
     // Finish off initializing bootstrapped modules.
     //
     for (auto& p: root.root_extra->modules)
@@ -1314,8 +1383,8 @@ namespace build2
     //
     dir_path hd (out_root / root.root_extra->root_dir);
 
-    bool he (exists (hd));
-    bool fe (exists (f));
+    bool he (probe (&root.ctx, hd));
+    bool fe (probe (&root.ctx, f));
 
 
     // Reuse the parser to accumulate the configuration variable information.
@@ -1535,6 +1604,7 @@ namespace build2
       if (verb >= 3)
         print_process (args);
 
+      process_span ps (args);
       process pr (pp,
                   args,
                   -2           /* stdin  to /dev/null                 */,
@@ -2173,6 +2243,8 @@ namespace build2
     context& ctx (base.ctx);
     assert (ctx.phase == run_phase::load);
 
+    load_stat::frame lsf (ctx, load_stat::import);
+
     // If metadata is requested, delegate to import_direct() which will lookup
     // the target and verify the metadata was loaded.
     //
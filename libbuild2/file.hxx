@@ -60,6 +60,12 @@ namespace build2
   LIBBUILD2_SYMEXPORT dir_path
   find_src_root (const dir_path&, optional<bool>& altn);
 
+  // As above but, if called during load, cache the filesystem probes in the
+  // context (see filesystem_cache for details).
+  //
+  LIBBUILD2_SYMEXPORT dir_path
+  find_src_root (context&, const dir_path&, optional<bool>& altn);
+
   // The same as above but for project's out. Note that we also check whether
   // a directory happens to be src_root, in case this is an in-tree build with
   // the result returned as the second half of the pair. Note also that if the
@@ -68,6 +74,9 @@ namespace build2
   LIBBUILD2_SYMEXPORT pair<dir_path, bool>
   find_out_root (const dir_path&, optional<bool>& altn);
 
+  LIBBUILD2_SYMEXPORT pair<dir_path, bool>
+  find_out_root (context&, const dir_path&, optional<bool>& altn);
+
   // Project's loading stage during which the parsing is performed.
   //
   enum class load_stage
@@ -0,0 +1,73 @@
+// file      : libbuild2/filesystem-cache.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/filesystem-cache.hxx>
+
+#include <libbuild2/filesystem.hxx>
+
+using namespace std;
+using namespace butl;
+
+namespace build2
+{
+  const paths& filesystem_cache::
+  search (const path& pattern,
+          const dir_path& start,
+          const string& fk,
+          const search_filter& filter)
+  {
+    auto k (make_tuple (start, pattern.representation (), fk));
+
+    auto i (searches_.find (k));
+    if (i != searches_.end ())
+      return i->second;
+
+    paths r;
+    auto add = [&r, &filter] (path&& m, const string& p, bool interm)
+    {
+      if (filter != nullptr && !filter (m, p))
+        return !interm;
+
+      if (!interm)
+        r.push_back (move (m));
+
+      return true;
+    };
+
+    path_search (pattern, add, start);
+
+    return searches_.emplace (move (k), move (r)).first->second;
+  }
+
+  bool filesystem_cache::
+  exists (const path& f)
+  {
+    auto i (file_exists_.find (f));
+    if (i != file_exists_.end ())
+      return i->second;
+
+    bool r (build2::exists (f));
+    file_exists_.emplace (f, r);
+    return r;
+  }
+
+  bool filesystem_cache::
+  exists (const dir_path& d)
+  {
+    auto i (dir_exists_.find (d));
+    if (i != dir_exists_.end ())
+      return i->second;
+
+    bool r (build2::exists (d));
+    dir_exists_.emplace (d, r);
+    return r;
+  }
+
+  void filesystem_cache::
+  clear ()
+  {
+    searches_.clear ();
+    file_exists_.clear ();
+    dir_exists_.clear ();
+  }
+}
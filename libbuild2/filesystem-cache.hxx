@@ -0,0 +1,82 @@
+// file      : libbuild2/filesystem-cache.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_FILESYSTEM_CACHE_HXX
+#define LIBBUILD2_FILESYSTEM_CACHE_HXX
+
+#include <map>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/export.hxx>
+
+namespace build2
+{
+  // Cache of the filesystem state observed during load.
+  //
+  // Loading a large project can query the same filesystem state many times.
+  // For example, {hxx ixx txx cxx}{**} results in four searches of the same
+  // directory tree with each checking every subdirectory for .buildignore
+  // and the same pattern can be searched for by several buildfiles or
+  // $path_search() calls. Similarly, project discovery and bootstrap probe
+  // the same directories for build/bootstrap.build, etc., for the
+  // amalgamation, each subproject, and each import. Since during load we
+  // assume the filesystem is not changed behind our back, we can remember
+  // the outcomes of such queries.
+  //
+  // Execute, however, can change the filesystem (for example, create
+  // generated source code) and so the cache is cleared before each load
+  // that may follow execute (by the driver before loading for the next
+  // operation and on switching to the load phase during match).
+  //
+  // Note that the cache is not thread-safe and should only be used during
+  // the load phase (which is exclusive).
+  //
+  class LIBBUILD2_SYMEXPORT filesystem_cache
+  {
+  public:
+    // Return the filesystem entries that match the pattern in the order
+    // they were found (see butl::path_search() for semantics). The filter
+    // is called for each candidate entry with the pattern component that
+    // matched it and should return false if the entry should be ignored
+    // (and, if it is an intermediate directory, not descended into).
+    //
+    // The filter should only depend on its arguments and on what is
+    // identified by the filter key (an arbitrary string, empty if there is
+    // no filter): if the search with the same pattern, start directory, and
+    // key has already been performed, then the previous result is returned
+    // without calling the filter.
+    //
+    // Throw system_error on failure to scan a directory (in which case the
+    // result is not cached).
+    //
+    using search_filter = function<bool (const path& entry,
+                                         const string& pattern)>;
+
+    const paths&
+    search (const path& pattern,
+            const dir_path& start,
+            const string& filter_key = string (),
+            const search_filter& = nullptr);
+
+    // Return true if the file or directory exists (see build2::exists()
+    // for details).
+    //
+    bool
+    exists (const path&);
+
+    bool
+    exists (const dir_path&);
+
+    void
+    clear ();
+
+  private:
+    std::map<std::tuple<dir_path, string, string>, paths> searches_;
+    std::map<path, bool> file_exists_;
+    std::map<dir_path, bool> dir_exists_;
+  };
+}
+
+#endif // LIBBUILD2_FILESYSTEM_CACHE_HXX
@@ -66,7 +66,7 @@ namespace build2
     // defined.
     //
     if (name.back () != '.')
-      return map_.find (name) != map_.end ();
+      return index_.find (name) != index_.end ();
 
     // If any function of the specified family is already defined, then one of
     // them should be the first element that is greater than the dot-terminated
@@ -92,15 +92,34 @@ namespace build2
     auto i (map_.emplace (move (name), move (f)));
 
     i->second.name = i->first.c_str ();
+    index_[i->first].push_back (&i->second);
+    generation_++;
     return i;
   }
 
+  void function_map::
+  erase (iterator i)
+  {
+    auto j (index_.find (i->first));
+    assert (j != index_.end ());
+
+    auto& fs (j->second);
+    fs.erase (find (fs.begin (), fs.end (), &i->second));
+
+    if (fs.empty ())
+      index_.erase (j);
+
+    map_.erase (i);
+    generation_++;
+  }
+
   pair<value, bool> function_map::
   call (const scope* base,
         const string& name,
         vector_view<value> args,
         const location& loc,
-        bool fa) const
+        bool fa,
+        call_cache* cache) const
   {
     auto print_call = [&name, &args] (ostream& os)
     {
@@ -115,83 +134,126 @@ namespace build2
       os << ')';
     };
 
-    // Overload resolution.
-    //
-    // See the overall function machinery description for the ranking
-    // semantics.
-    //
-    auto ip (map_.equal_range (name));
-
     size_t rank (~0);
     small_vector<const function_overload*, 2> ovls;
+
+    // See if we can reuse the resolution from the previous call at this
+    // call site.
+    //
+    auto cached = [cache, &name, &args, this] ()
     {
-      size_t count (args.size ());
+      if (cache == nullptr                     ||
+          cache->generation != generation_     ||
+          cache->types.size () != args.size () ||
+          cache->name != name)
+        return false;
 
-      for (auto it (ip.first); it != ip.second; ++it)
+      for (size_t i (0); i != args.size (); ++i)
       {
-        const function_overload& f (it->second);
+        if (args[i].type != cache->types[i])
+          return false;
+      }
 
-        // Argument count match.
-        //
-        if (count < f.arg_min || count > f.arg_max)
-          continue;
+      return true;
+    };
 
-        // Argument types match.
-        //
-        size_t r (0);
+    if (cached ())
+    {
+      rank = cache->rank;
+      ovls.push_back (cache->overload);
+    }
+    else
+    {
+      // Overload resolution.
+      //
+      // See the overall function machinery description for the ranking
+      // semantics.
+      //
+      auto j (index_.find (name));
+
+      if (j != index_.end ())
+      {
+        size_t count (args.size ());
+
+        for (const function_overload* pf: j->second)
         {
-          size_t i (0), n (min (count, f.arg_types.size ()));
-          for (; i != n; ++i)
+          const function_overload& f (*pf);
+
+          // Argument count match.
+          //
+          if (count < f.arg_min || count > f.arg_max)
+            continue;
+
+          // Argument types match.
+          //
+          size_t r (0);
           {
-            if (!f.arg_types[i]) // Anytyped.
-              continue;
+            size_t i (0), n (min (count, f.arg_types.size ()));
+            for (; i != n; ++i)
+            {
+              if (!f.arg_types[i]) // Anytyped.
+                continue;
 
-            const value_type* at (args[i].type);
-            const value_type* ft (*f.arg_types[i]);
+              const value_type* at (args[i].type);
+              const value_type* ft (*f.arg_types[i]);
 
-            if (at == ft) // Types match perfectly.
-              continue;
+              if (at == ft) // Types match perfectly.
+                continue;
 
-            if (at != nullptr && ft != nullptr)
-            {
-              while ((at = at->base_type) != nullptr && at != ft) ;
+              if (at != nullptr && ft != nullptr)
+              {
+                while ((at = at->base_type) != nullptr && at != ft) ;
+
+                if (at != nullptr) // Types match via derived-to-base.
+                {
+                  if (r < 1)
+                    r = 1;
+                  continue;
+                }
+              }
 
-              if (at != nullptr) // Types match via derived-to-base.
+              if (ft == nullptr) // Types match via reversal to untyped.
               {
-                if (r < 1)
-                  r = 1;
+                if (r < 2)
+                  r = 2;
                 continue;
               }
+
+              break; // No match.
             }
 
-            if (ft == nullptr) // Types match via reversal to untyped.
+            if (i != n)
+              continue; // No match.
+          }
+
+          // Better or just as good a match?
+          //
+          if (r <= rank)
+          {
+            if (r < rank) // Better.
             {
-              if (r < 2)
-                r = 2;
-              continue;
+              rank = r;
+              ovls.clear ();
             }
 
-            break; // No match.
+            ovls.push_back (&f);
           }
 
-          if (i != n)
-            continue; // No match.
+          // Continue looking to detect ambiguities.
         }
+      }
 
-        // Better or just as good a match?
-        //
-        if (r <= rank)
-        {
-          if (r < rank) // Better.
-          {
-            rank = r;
-            ovls.clear ();
-          }
+      if (cache != nullptr && ovls.size () == 1)
+      {
+        cache->generation = generation_;
+        cache->name = name;
+        cache->types.clear ();
 
-          ovls.push_back (&f);
-        }
+        for (size_t i (0); i != args.size (); ++i)
+          cache->types.push_back (args[i].type);
 
-        // Continue looking to detect ambiguities.
+        cache->overload = ovls.back ();
+        cache->rank = rank;
       }
     }
 
@@ -257,8 +319,15 @@ namespace build2
 
         dr << fail (loc) << "unmatched call to "; print_call (dr.os);
 
-        for (auto i (ip.first); i != ip.second; ++i)
-          dr << info << "candidate: " << i->second;
+        {
+          auto i (index_.find (name));
+
+          if (i != index_.end ())
+          {
+            for (const function_overload* f: i->second)
+              dr << info << "candidate: " << *f;
+          }
+        }
 
         // If this is an unqualified name, then also print qualified
         // functions that end with this name. But skip functions that we
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <utility>       // index_sequence
+#include <unordered_map>
 #include <type_traits>   // aligned_storage
 
 #include <libbuild2/types.hxx>
@@ -159,6 +160,10 @@ namespace build2
   LIBBUILD2_SYMEXPORT ostream&
   operator<< (ostream&, const function_overload&); // Print signature.
 
+  // The overloads are stored in a map ordered by name (which is used to
+  // look up function families and to print diagnostics) and are also
+  // indexed by name in a hash table (which is used to resolve calls).
+  //
   class LIBBUILD2_SYMEXPORT function_map
   {
   public:
@@ -170,15 +175,35 @@ namespace build2
     insert (string name, function_overload);
 
     void
-    erase (iterator i) {map_.erase (i);}
+    erase (iterator);
+
+    // Call site resolution cache.
+    //
+    // The same call site is normally called with the same argument types
+    // (think a function call in a for-loop body) so the caller can save the
+    // result of the overload resolution and reuse it on subsequent calls if
+    // the name and the argument types match. The cache is invalidated if
+    // any functions are inserted or erased (for example, by a module being
+    // loaded). Note that the cache is not thread-safe.
+    //
+    struct call_cache
+    {
+      size_t generation = 0; // Never matches a valid generation.
+      string name;
+      small_vector<const value_type*, 3> types;
+
+      const function_overload* overload;
+      size_t rank;
+    };
 
     value
     call (const scope* base,
           const string& name,
           vector_view<value> args,
-          const location& l) const
+          const location& l,
+          call_cache* cache = nullptr) const
     {
-      return call (base, name, args, l, true).first;
+      return call (base, name, args, l, true, cache).first;
     }
 
     // As above but do not fail if no match was found (but still do if the
@@ -192,7 +217,7 @@ namespace build2
               vector_view<value> args,
               const location& l) const
     {
-      return call (base, name, args, l, false);
+      return call (base, name, args, l, false, nullptr);
     }
 
     iterator
@@ -220,9 +245,17 @@ namespace build2
           const string&,
           vector_view<value>,
           const location&,
-          bool fail) const;
+          bool fail,
+          call_cache*) const;
 
     map_type map_;
+
+    // Overloads by name in the insertion order.
+    //
+    std::unordered_map<string,
+                       small_vector<const function_overload*, 2>> index_;
+
+    size_t generation_ = 1;
   };
 
   LIBBUILD2_SYMEXPORT void
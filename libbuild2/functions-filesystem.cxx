@@ -3,6 +3,7 @@
 
 #include <libbutl/filesystem.mxx>
 
+#include <libbuild2/scope.hxx>
 #include <libbuild2/function.hxx>
 #include <libbuild2/variable.hxx>
 
@@ -13,20 +14,40 @@ namespace build2
   // Return paths of filesystem entries that match the pattern. See
   // path_search() overloads (below) for details.
   //
+  // During load the search results are cached (see filesystem_cache for
+  // details).
+  //
   static names
-  path_search (const path& pattern, const optional<dir_path>& start)
+  path_search (const scope* s,
+               const path& pattern,
+               const optional<dir_path>& start)
   {
     names r;
-    auto add = [&r] (path&& p, const std::string&, bool interm) -> bool
+    auto add = [&r] (path&& p)
     {
       // Canonicalizing paths seems to be the right thing to do. Otherwise, we
       // can end up with different separators in the same path on Windows.
       //
-      if (!interm)
-        r.emplace_back (
-          value_traits<path>::reverse (move (p.canonicalize ())));
+      r.emplace_back (value_traits<path>::reverse (move (p.canonicalize ())));
+    };
 
-      return true;
+    auto search = [s, &pattern, &add] (const dir_path& start)
+    {
+      if (s != nullptr && s->ctx.phase == run_phase::load)
+      {
+        for (const path& p: s->ctx.filesystem_cache.search (pattern, start))
+          add (path (p));
+      }
+      else
+        path_search (pattern,
+                     [&add] (path&& p, const std::string&, bool interm)
+                     {
+                       if (!interm)
+                         add (move (p));
+
+                       return true;
+                     },
+                     start);
     };
 
     // Print paths "as is" in the diagnostics.
@@ -34,7 +55,7 @@ namespace build2
     try
     {
       if (pattern.absolute ())
-        path_search (pattern, add);
+        search (empty_dir_path);
       else
       {
         // An absolute start directory must be specified for the relative
@@ -54,7 +75,7 @@ namespace build2
              << "' is relative";
         }
 
-        path_search (pattern, add, *start);
+        search (*start);
       }
     }
     catch (const system_error& e)
@@ -86,24 +107,29 @@ namespace build2
     // absolute path, then the start directory is ignored (if present).
     // Otherwise, the start directory must be specified and be absolute.
     //
-    f["path_search"] = [](path pattern, optional<dir_path> start)
+    f["path_search"] = [](const scope* s,
+                          path pattern,
+                          optional<dir_path> start)
     {
-      return path_search (pattern, start);
+      return path_search (s, pattern, start);
     };
 
-    f["path_search"] = [](path pattern, names start)
+    f["path_search"] = [](const scope* s, path pattern, names start)
     {
-      return path_search (pattern, convert<dir_path> (move (start)));
+      return path_search (s, pattern, convert<dir_path> (move (start)));
     };
 
-    f["path_search"] = [](names pattern, optional<dir_path> start)
+    f["path_search"] = [](const scope* s,
+                          names pattern,
+                          optional<dir_path> start)
     {
-      return path_search (convert<path> (move (pattern)), start);
+      return path_search (s, convert<path> (move (pattern)), start);
     };
 
-    f["path_search"] = [](names pattern, names start)
+    f["path_search"] = [](const scope* s, names pattern, names start)
     {
-      return path_search (convert<path>     (move (pattern)),
+      return path_search (s,
+                          convert<path>     (move (pattern)),
                           convert<dir_path> (move (start)));
     };
   }
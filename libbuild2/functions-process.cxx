@@ -4,8 +4,10 @@
 #include <libbutl/regex.mxx>
 #include <libbutl/builtin.mxx>
 
+#include <libbuild2/scope.hxx>
 #include <libbuild2/function.hxx>
 #include <libbuild2/variable.hxx>
+#include <libbuild2/load-stat.hxx>
 
 using namespace std;
 using namespace butl;
@@ -129,11 +131,15 @@ namespace build2
   // Run a builtin. The builtin name is only used for diagnostics.
   //
   static value
-  run_builtin_impl (builtin_function* bf,
+  run_builtin_impl (const scope* s,
+                    builtin_function* bf,
                     const strings& args,
                     const string& bn,
                     const read_function& read)
   {
+    load_stat::frame lsf (s != nullptr ? &s->ctx : nullptr,
+                          load_stat::process);
+
     try
     {
       dir_path cwd;
@@ -180,13 +186,17 @@ namespace build2
   }
 
   static inline value
-  run_builtin (builtin_function* bf, const strings& args, const string& bn)
+  run_builtin (const scope* s,
+               builtin_function* bf,
+               const strings& args,
+               const string& bn)
   {
-    return run_builtin_impl (bf, args, bn, read);
+    return run_builtin_impl (s, bf, args, bn, read);
   }
 
   static inline value
-  run_builtin_regex (builtin_function* bf,
+  run_builtin_regex (const scope* s,
+                     builtin_function* bf,
                      const strings& args,
                      const string& bn,
                      const string& pat,
@@ -194,7 +204,7 @@ namespace build2
   {
     // Note that we rely on the "small function object" optimization here.
     //
-    return run_builtin_impl (bf, args, bn,
+    return run_builtin_impl (s, bf, args, bn,
                              [&pat, &fmt] (auto_fd&& fd)
                              {
                                return read_regex (move (fd), pat, fmt);
@@ -306,7 +316,11 @@ namespace build2
                     const strings& args,
                     const read_function& read)
   {
+    load_stat::frame lsf (s != nullptr ? &s->ctx : nullptr,
+                          load_stat::process);
+
     cstrings cargs;
+    process_span ps (cargs);
     process pr (process_start (s, pp, args, cargs));
 
     value r;
@@ -355,7 +369,7 @@ namespace build2
     if (builtin_function* bf = builtin (args))
     {
       pair<string, strings> ba (builtin_args (bf, move (args), "run"));
-      return run_builtin (bf, ba.second, ba.first);
+      return run_builtin (s, bf, ba.second, ba.first);
     }
     else
     {
@@ -373,7 +387,7 @@ namespace build2
     if (builtin_function* bf = builtin (args))
     {
       pair<string, strings> ba (builtin_args (bf, move (args), "run_regex"));
-      return run_builtin_regex (bf, ba.second, ba.first, pat, fmt);
+      return run_builtin_regex (s, bf, ba.second, ba.first, pat, fmt);
     }
     else
     {
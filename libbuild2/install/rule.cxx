@@ -20,13 +20,21 @@ namespace build2
 {
   namespace install
   {
+    // Variables looked up for every target and prerequisite (see
+    // builtin_variable for details).
+    //
+    static const builtin_variable var_install ("install");
+    static const builtin_variable var_install_subdirs ("install.subdirs");
+    static const builtin_variable var_install_mode ("install.mode");
+
     // Lookup the install or install.* variable. Return NULL if not found or
     // if the value is the special 'false' name (which means do not install;
-    // so the result can be used as bool). T is either scope or target.
+    // so the result can be used as bool). T is either scope or target and V
+    // is either variable name or builtin_variable.
     //
-    template <typename P, typename T>
+    template <typename P, typename T, typename V>
     static const P*
-    lookup_install (T& t, const string& var)
+    lookup_install (T& t, const V& var)
     {
       auto l (t[var]);
 
@@ -119,7 +127,7 @@ namespace build2
         //
         // Note: not the same as lookup_install() above.
         //
-        auto l ((*pt)["install"]);
+        auto l ((*pt)[var_install]);
         if (l && cast<path> (l).string () == "false")
         {
           l5 ([&]{trace << "ignoring " << *pt << " (not installable)";});
@@ -240,7 +248,7 @@ namespace build2
           //
           // Note: not the same as lookup_install() above.
           //
-          auto l ((*mt)["install"]);
+          auto l ((*mt)[var_install]);
           if (l && cast<path> (l).string () == "false")
           {
             l5 ([&]{trace << "ignoring " << *mt << " (not installable)";});
@@ -299,7 +307,7 @@ namespace build2
       // un/install) we delegate to the normal update and in the second
       // (un/install) -- perform the test.
       //
-      if (!lookup_install<path> (t, "install"))
+      if (!lookup_install<path> (t, var_install))
         return noop_recipe;
 
       // In both cases, the next step is to search, match, and collect all the
@@ -352,7 +360,7 @@ namespace build2
         //
         // Note: not the same as lookup_install() above.
         //
-        auto l ((*pt)["install"]);
+        auto l ((*pt)[var_install]);
         if (l && cast<path> (l).string () == "false")
         {
           l5 ([&]{trace << "ignoring " << *pt << " (not installable)";});
@@ -613,7 +621,7 @@ namespace build2
     {
       // Note: similar logic to perform_install().
       //
-      const path* p (lookup_install<path> (f, "install"));
+      const path* p (lookup_install<path> (f, var_install));
 
       if (p == nullptr) // Not installable.
         return path ();
@@ -625,7 +633,7 @@ namespace build2
 
       if (!n)
       {
-        if (auto l = f["install.subdirs"])
+        if (auto l = f[var_install_subdirs])
         {
           if (cast<bool> (l))
             resolve_subdir (ids, f, f.base_scope (), l);
@@ -930,7 +938,7 @@ namespace build2
         //
         if (!n)
         {
-          if (auto l = t["install.subdirs"])
+          if (auto l = t[var_install_subdirs])
           {
             if (cast<bool> (l))
               resolve_subdir (ids, t, t.base_scope (), l);
@@ -948,7 +956,7 @@ namespace build2
 
         // Override mode if one was specified.
         //
-        if (auto l = t["install.mode"])
+        if (auto l = t[var_install_mode])
           id.mode = &cast<string> (l);
 
         // Install the target.
@@ -986,7 +994,7 @@ namespace build2
         {
           if (!mf->path ().empty () && mf->mtime () != timestamp_nonexistent)
           {
-            if (const path* p = lookup_install<path> (*mf, "install"))
+            if (const path* p = lookup_install<path> (*mf, var_install))
             {
               install_target (*mf, *p, tp.empty () ? 1 : 2);
               r |= target_state::changed;
@@ -1000,7 +1008,7 @@ namespace build2
       //
       if (!tp.empty ())
       {
-        install_target (t, cast<path> (t["install"]), 1);
+        install_target (t, cast<path> (t[var_install]), 1);
         r |= target_state::changed;
       }
 
@@ -1214,7 +1222,7 @@ namespace build2
         //
         if (!n)
         {
-          if (auto l = t["install.subdirs"])
+          if (auto l = t[var_install_subdirs])
           {
             if (cast<bool> (l))
               resolve_subdir (ids, t, t.base_scope (), l);
@@ -1252,7 +1260,7 @@ namespace build2
       target_state r (target_state::unchanged);
 
       if (!tp.empty ())
-        r |= uninstall_target (t, cast<path> (t["install"]), 1);
+        r |= uninstall_target (t, cast<path> (t[var_install]), 1);
 
       // Then installable ad hoc group members, if any. To be anally precise,
       // we would have to do it in reverse, but that's not easy (it's a
@@ -1266,7 +1274,7 @@ namespace build2
         {
           if (!mf->path ().empty () && mf->mtime () != timestamp_nonexistent)
           {
-            if (const path* p = lookup_install<path> (*m, "install"))
+            if (const path* p = lookup_install<path> (*m, var_install))
             {
               r |= uninstall_target (
                 *mf,
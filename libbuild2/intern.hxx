@@ -0,0 +1,58 @@
+// file      : libbuild2/intern.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_INTERN_HXX
+#define LIBBUILD2_INTERN_HXX
+
+#include <unordered_set>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+namespace build2
+{
+  // Thread-safe pool of interned values (for example, target directories
+  // and names). Each distinct value is stored once and the returned
+  // reference remains valid for as long as the pool exists, so that values
+  // from the same pool can be compared for equality by address.
+  //
+  // Similar to target_set, the pool is split into shards by the value hash
+  // to reduce contention between threads interning concurrently.
+  //
+  template <typename T>
+  class intern_pool
+  {
+  public:
+    const T&
+    insert (T);
+
+    // Return the number of values in the pool and the approximate memory
+    // they occupy (see memory_stat). Note: not MT-safe.
+    //
+    size_t
+    size () const;
+
+    size_t
+    bytes () const;
+
+    intern_pool () = default;
+
+    intern_pool (const intern_pool&) = delete;
+    intern_pool& operator= (const intern_pool&) = delete;
+
+  private:
+    struct shard
+    {
+      mutable shared_mutex mutex;
+      std::unordered_set<T> set;
+    };
+
+    static const size_t shard_count = 16;
+
+    shard shards_[shard_count];
+  };
+}
+
+#include <libbuild2/intern.txx>
+
+#endif // LIBBUILD2_INTERN_HXX
@@ -0,0 +1,55 @@
+// file      : libbuild2/intern.txx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/memory-stat.hxx> // heap_bytes()
+
+namespace build2
+{
+  template <typename T>
+  const T& intern_pool<T>::
+  insert (T v)
+  {
+    shard& s (shards_[hash<T> () (v) % shard_count]);
+
+    // Most of the time the value is already in the pool.
+    //
+    {
+      slock l (s.mutex);
+
+      auto i (s.set.find (v));
+      if (i != s.set.end ())
+        return *i;
+    }
+
+    ulock l (s.mutex);
+    return *s.set.insert (move (v)).first;
+  }
+
+  template <typename T>
+  size_t intern_pool<T>::
+  size () const
+  {
+    size_t r (0);
+    for (const shard& s: shards_)
+      r += s.set.size ();
+    return r;
+  }
+
+  template <typename T>
+  size_t intern_pool<T>::
+  bytes () const
+  {
+    size_t r (0);
+    for (const shard& s: shards_)
+    {
+      // Node (value, next pointer, and cached hash) plus bucket.
+      //
+      r += s.set.size () * (sizeof (T) + 2 * sizeof (void*)) +
+        s.set.bucket_count () * sizeof (void*);
+
+      for (const T& v: s.set)
+        r += heap_bytes (v);
+    }
+    return r;
+  }
+}
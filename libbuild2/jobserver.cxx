@@ -0,0 +1,266 @@
+// file      : libbuild2/jobserver.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/jobserver.hxx>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <unistd.h>    // read(), write(), close(), unlink()
+#  include <sys/stat.h>  // mkfifo()
+#else
+#  include <libbutl/win32-utility.hxx>
+#endif
+
+#include <cerrno>
+#include <cstdlib> // strtol()
+
+using namespace std;
+
+namespace build2
+{
+  // Extract the jobserver specification from the MAKEFLAGS value. Note that
+  // if specified multiple times, then the last one wins.
+  //
+  static string
+  jobserver_auth (const string& f)
+  {
+    string r;
+
+    for (size_t p (0); p != f.size (); )
+    {
+      size_t e (f.find (' ', p));
+      if (e == string::npos)
+        e = f.size ();
+
+      // Note: --jobserver-fds is the pre-4.2 GNU make name.
+      //
+      if (f.compare (p, 17, "--jobserver-auth=") == 0)
+        r.assign (f, p + 17, e - p - 17);
+      else if (f.compare (p, 16, "--jobserver-fds=") == 0)
+        r.assign (f, p + 16, e - p - 16);
+
+      p = e != f.size () ? e + 1 : e;
+    }
+
+    return r;
+  }
+
+  unique_ptr<jobserver> jobserver::
+  client ()
+  {
+    optional<string> f (getenv ("MAKEFLAGS"));
+    if (!f)
+      return nullptr;
+
+    string a (jobserver_auth (*f));
+    if (a.empty ())
+      return nullptr;
+
+    unique_ptr<jobserver> r (new jobserver);
+
+#ifndef _WIN32
+    if (a.compare (0, 5, "fifo:") == 0)
+    {
+      // Open the read end in the non-blocking mode first so that opening
+      // the write end doesn't block.
+      //
+      const char* p (a.c_str () + 5);
+
+      if ((r->rfd_ = open (p, O_RDONLY | O_NONBLOCK | O_CLOEXEC)) == -1 ||
+          (r->wfd_ = open (p, O_WRONLY | O_CLOEXEC)) == -1)
+        throw_generic_error (errno);
+    }
+    else
+    {
+      char* e;
+      long rfd (strtol (a.c_str (), &e, 10));
+      if (*e != ',')
+        return nullptr;
+
+      long wfd (strtol (e + 1, &e, 10));
+      if (*e != '\0' || rfd < 0 || wfd < 0)
+        return nullptr;
+
+      // If make didn't consider us a recursive invocation, then these file
+      // descriptors are not open (or, worse, are reused for something else).
+      //
+      if (fcntl (static_cast<int> (rfd), F_GETFD) == -1 ||
+          fcntl (static_cast<int> (wfd), F_GETFD) == -1)
+        return nullptr;
+
+      // We need to read the tokens without blocking but we cannot switch the
+      // inherited pipe to the non-blocking mode since this flag is shared
+      // with make and other processes. On Linux we can, however, re-open the
+      // pipe via /proc which gives us our own open file description. On
+      // other platforms we give up.
+      //
+#ifdef __linux__
+      string p ("/proc/self/fd/" + to_string (rfd));
+
+      r->rfd_ = open (p.c_str (), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+      if (r->rfd_ == -1)
+        throw_generic_error (errno);
+
+      r->wfd_ = fcntl (static_cast<int> (wfd), F_DUPFD_CLOEXEC, 0);
+      if (r->wfd_ == -1)
+        throw_generic_error (errno);
+#else
+      return nullptr;
+#endif
+    }
+#else
+    if ((r->sem_ = OpenSemaphoreA (SEMAPHORE_ALL_ACCESS,
+                                   FALSE,
+                                   a.c_str ())) == nullptr)
+      throw_system_error (GetLastError ());
+#endif
+
+    return r;
+  }
+
+  unique_ptr<jobserver> jobserver::
+  server (size_t jobs)
+  {
+    assert (jobs != 0);
+
+    unique_ptr<jobserver> r (new jobserver);
+
+    string a;
+
+#ifndef _WIN32
+    r->fifo_ = path::temp_path ("build2-jobserver");
+
+    const char* p (r->fifo_.string ().c_str ());
+
+    if (mkfifo (p, 0600) == -1)
+    {
+      int e (errno);
+      r->fifo_.clear (); // Nothing to remove.
+      throw_generic_error (e);
+    }
+
+    if ((r->rfd_ = open (p, O_RDONLY | O_NONBLOCK | O_CLOEXEC)) == -1 ||
+        (r->wfd_ = open (p, O_WRONLY | O_CLOEXEC)) == -1)
+      throw_generic_error (errno);
+
+    // Fill the pool.
+    //
+    {
+      string t (jobs - 1, '+');
+
+      for (size_t i (0); i != t.size (); )
+      {
+        ssize_t n (write (r->wfd_, t.c_str () + i, t.size () - i));
+
+        if (n == -1)
+        {
+          if (errno == EINTR)
+            continue;
+
+          throw_generic_error (errno);
+        }
+
+        i += static_cast<size_t> (n);
+      }
+    }
+
+    a = "fifo:" + r->fifo_.string ();
+#else
+    a = "build2-jobserver-" + to_string (GetCurrentProcessId ());
+
+    LONG n (static_cast<LONG> (jobs - 1));
+
+    if ((r->sem_ = CreateSemaphoreA (nullptr, n, n, a.c_str ())) == nullptr)
+      throw_system_error (GetLastError ());
+#endif
+
+    // Preserve the rest of MAKEFLAGS, if any. Note that since the last
+    // --jobserver-auth wins, any stale value will be overridden.
+    //
+    if (optional<string> f = getenv ("MAKEFLAGS"))
+      r->makeflags_ = move (*f);
+
+    r->makeflags_ += " -j" + to_string (jobs);
+    r->makeflags_ += " --jobserver-auth=" + a;
+
+    return r;
+  }
+
+  bool jobserver::
+  try_acquire ()
+  {
+#ifndef _WIN32
+    for (char c;;)
+    {
+      ssize_t n (read (rfd_, &c, 1));
+
+      if (n == 1)
+      {
+        tokens_ += c;
+        return true;
+      }
+
+      // EAGAIN means there are no tokens available at the moment. Treat
+      // EOF and other errors the same way (the pool must have gone away).
+      //
+      if (n == -1 && errno == EINTR)
+        continue;
+
+      return false;
+    }
+#else
+    if (WaitForSingleObject (sem_, 0) != WAIT_OBJECT_0)
+      return false;
+
+    tokens_ += '+';
+    return true;
+#endif
+  }
+
+  void jobserver::
+  release ()
+  {
+    assert (!tokens_.empty ());
+
+    // Note that we have no way to report an error here and there is not
+    // much we can do about it anyway other than losing the token.
+    //
+#ifndef _WIN32
+    char c (tokens_.back ());
+
+    while (write (wfd_, &c, 1) == -1 && errno == EINTR) ;
+#else
+    ReleaseSemaphore (sem_, 1, nullptr);
+#endif
+
+    tokens_.pop_back ();
+  }
+
+  jobserver::
+  ~jobserver ()
+  {
+#ifndef _WIN32
+    if (wfd_ != -1)
+    {
+      while (!tokens_.empty ())
+        release ();
+
+      close (wfd_);
+    }
+
+    if (rfd_ != -1)
+      close (rfd_);
+
+    if (!fifo_.empty ())
+      unlink (fifo_.string ().c_str ());
+#else
+    if (sem_ != nullptr)
+    {
+      while (!tokens_.empty ())
+        release ();
+
+      CloseHandle (sem_);
+    }
+#endif
+  }
+}
@@ -0,0 +1,107 @@
+// file      : libbuild2/jobserver.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_JOBSERVER_HXX
+#define LIBBUILD2_JOBSERVER_HXX
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/export.hxx>
+
+namespace build2
+{
+  // GNU make-compatible jobserver.
+  //
+  // A jobserver is a pool of tokens shared between cooperating processes
+  // (make, nested build system invocations, compilers that support
+  // -flto=jobserver, etc) that limits the total number of jobs performed by
+  // all of them. Each process has one implicit token and must acquire an
+  // additional token from the pool for every extra job it wants to perform
+  // concurrently, returning it once done.
+  //
+  // The pool is communicated to child processes via the MAKEFLAGS
+  // environment variable. On POSIX it is either a named pipe
+  // (--jobserver-auth=fifo:PATH, GNU make 4.4 and later) or a pair of
+  // inherited pipe file descriptors (--jobserver-auth=R,W or, prior to GNU
+  // make 4.2, --jobserver-fds=R,W). On Windows it is a named semaphore
+  // (--jobserver-auth=NAME).
+  //
+  // Note that this class is not thread-safe (the scheduler only uses it
+  // while holding its mutex).
+  //
+  class LIBBUILD2_SYMEXPORT jobserver
+  {
+  public:
+    // Connect to the jobserver specified in the MAKEFLAGS environment
+    // variable. Return NULL if there is no jobserver or if it cannot be used
+    // (for example, the pipe file descriptors were not passed to us because
+    // we were not marked as a recursive make invocation). Throw system_error
+    // if unable to connect to the jobserver.
+    //
+    static unique_ptr<jobserver>
+    client ();
+
+    // Create a new jobserver for the specified number of jobs (that is, with
+    // jobs - 1 tokens in the pool). The makeflags() value should then be
+    // exported to child processes. Throw system_error on failure.
+    //
+    // Note that on POSIX the pool is a named pipe which is only understood
+    // by GNU make 4.4 and later.
+    //
+    static unique_ptr<jobserver>
+    server (size_t jobs);
+
+    // Try to acquire a token from the pool without blocking. Return true if
+    // successful.
+    //
+    bool
+    try_acquire ();
+
+    // Return a previously acquired token to the pool.
+    //
+    void
+    release ();
+
+    // Number of tokens currently acquired (not counting the implicit one).
+    //
+    size_t
+    acquired () const {return tokens_.size ();}
+
+    // The MAKEFLAGS value that should be exported to child processes or
+    // empty if the environment does not need to be changed.
+    //
+    const string&
+    makeflags () const {return makeflags_;}
+
+    // Return the acquired tokens, if any, and, for the server, remove the
+    // pool.
+    //
+    ~jobserver ();
+
+    jobserver (const jobserver&) = delete;
+    jobserver& operator= (const jobserver&) = delete;
+
+  private:
+    jobserver () = default;
+
+  private:
+    // The acquired tokens. GNU make expects us to return the same token
+    // values that we have read.
+    //
+    string tokens_;
+
+    string makeflags_;
+
+#ifndef _WIN32
+    int rfd_ = -1;
+    int wfd_ = -1;
+
+    path fifo_; // Server only.
+#else
+    void* sem_ = nullptr; // HANDLE
+#endif
+  };
+}
+
+#endif // LIBBUILD2_JOBSERVER_HXX
@@ -0,0 +1,158 @@
+// file      : libbuild2/lexer.bench.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <chrono>
+
+#include <cassert>
+#include <iostream>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/token.hxx>
+#include <libbuild2/lexer.hxx>
+#include <libbuild2/diagnostics.hxx>
+
+using namespace std;
+
+namespace build2
+{
+  // Usage: argv[0] [-r <rounds>] [-m <lexer-mode>] <buildfile>...
+  //
+  // -r  number of rounds, 10 by default
+  // -m  lexer mode, normal by default (see lexer.test.cxx for the names)
+  //
+  // Lex the specified buildfiles (normally real-world ones, for example,
+  // all the buildfiles of a large project) and measure the time it takes
+  // per byte and per token. Each round re-opens the files so that the
+  // lexer reads them through ifdstream the same way as during load (the
+  // files themselves are expected to be in the OS file cache after the
+  // first round).
+  //
+  // Note that without the parser switching the lexer modes the whole
+  // buildfile is lexed in the same mode. While this produces a slightly
+  // different token stream (for example, in the normal mode `=` and `+` in
+  // the variable values are separate tokens), the bulk of the work (words,
+  // spaces, comments) is the same.
+  //
+  static inline uint64_t
+  now ()
+  {
+    using namespace chrono;
+
+    return static_cast<uint64_t> (
+      duration_cast<nanoseconds> (
+        steady_clock::now ().time_since_epoch ()).count ());
+  }
+
+  int
+  main (int argc, char* argv[])
+  {
+    size_t rounds (10);
+    lexer_mode m (lexer_mode::normal);
+
+    paths fs;
+
+    for (int i (1); i != argc; ++i)
+    {
+      string a (argv[i]);
+
+      if (a == "-r")
+        rounds = stoul (argv[++i]);
+      else if (a == "-m")
+      {
+        a = argv[++i];
+
+        if      (a == "normal")     m = lexer_mode::normal;
+        else if (a == "variable")   m = lexer_mode::variable;
+        else if (a == "value")      m = lexer_mode::value;
+        else if (a == "attributes") m = lexer_mode::attributes;
+        else if (a == "eval")       m = lexer_mode::eval;
+        else if (a == "buildspec")  m = lexer_mode::buildspec;
+        else                        assert (false);
+      }
+      else
+        fs.push_back (path (move (a)));
+    }
+
+    assert (!fs.empty () && rounds != 0);
+
+    // Fake build system driver, default verbosity.
+    //
+    init_diag (1);
+
+    uint64_t bytes (0);
+    uint64_t tokens (0);
+    uint64_t best (0);
+
+    try
+    {
+      for (const path& f: fs)
+      {
+        ifdstream is (f);
+        bytes += is.read_text ().size ();
+      }
+
+      for (size_t r (0); r != rounds; ++r)
+      {
+        uint64_t n (0);
+        uint64_t s (now ());
+
+        for (const path& f: fs)
+        {
+          ifdstream is (f);
+          path_name in (f);
+          lexer l (is, in);
+
+          if (m != lexer_mode::normal)
+            l.mode (m);
+
+          // Most alternative modes auto-expire so re-enter the mode after
+          // each newline.
+          //
+          for (token t (l.next ()); t.type != token_type::eos; t = l.next ())
+          {
+            n++;
+
+            if (t.type == token_type::newline && m != lexer_mode::normal)
+              l.mode (m);
+          }
+        }
+
+        uint64_t e (now ());
+
+        tokens = n;
+
+        if (r == 0 || e - s < best)
+          best = e - s;
+      }
+    }
+    catch (const io_error& e)
+    {
+      cerr << "error: unable to read buildfile: " << e << endl;
+      return 1;
+    }
+    catch (const failed&)
+    {
+      return 1;
+    }
+
+    uint64_t per_byte (bytes != 0 ? best / bytes : 0);
+    uint64_t per_token (tokens != 0 ? best / tokens : 0);
+
+    cout << "files                  " << fs.size () << endl
+         << "bytes                  " << bytes      << endl
+         << "tokens                 " << tokens     << endl
+         << "lex_best_us            " << best / 1000 << endl
+         << "lex_ns_per_byte        " << per_byte   << endl
+         << "lex_ns_per_token       " << per_token  << endl;
+
+    return 0;
+  }
+}
+
+int
+main (int argc, char* argv[])
+{
+  return build2::main (argc, argv);
+}
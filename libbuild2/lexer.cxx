@@ -134,7 +134,32 @@ namespace build2
     default: assert (false); // Unhandled custom mode.
     }
 
-    state_.push (state {m, a, ps, s, n, q, *esc, s1, s2});
+    state_.push (state {m, a, ps, s, n, q, *esc, s1, s2,
+                        special_chars (s1, ps, q)});
+  }
+
+  bitset<256> lexer::
+  special_chars (const char* sf, char ps, bool q)
+  {
+    bitset<256> r;
+
+    if (sf == nullptr)
+      return r.set ();
+
+    for (; *sf != '\0'; ++sf)
+      r.set (static_cast<unsigned char> (*sf));
+
+    if (ps != '\0')
+      r.set (static_cast<unsigned char> (ps));
+
+    if (q)
+    {
+      r.set ('\'');
+      r.set ('\"');
+    }
+
+    r.set ('\\');
+    return r;
   }
 
   token lexer::
@@ -516,6 +541,17 @@ namespace build2
 
     for (; !eos (c); c = peek ())
     {
+      // Fast path for characters that are not special in this mode (which
+      // is normally the bulk of a word). Note that for the ad hoc modes
+      // (variable, quoted) all the characters are special.
+      //
+      if (!st.special[static_cast<unsigned char> (c)])
+      {
+        get (c);
+        append (c);
+        continue;
+      }
+
       // First handle escape sequences.
       //
       if (c == '\\')
@@ -777,7 +813,7 @@ namespace build2
       case '#':
         {
           r = true;
-          get ();
+          get (c);
 
           // See if this is a multi-line comment in the form:
           //
@@ -804,7 +840,7 @@ namespace build2
             //
             for (; !eos (c); c = peek ())
             {
-              get ();
+              get (c);
               if (c == '#' && ml ())
                 break;
             }
@@ -817,17 +853,21 @@ namespace build2
             // Read until newline or eos.
             //
             for (; !eos (c) && c != '\n'; c = peek ())
-              get ();
+              get (c);
           }
 
           continue;
         }
       case '\\':
         {
-          get ();
+          get (c);
+          xchar p (peek ());
 
-          if (peek () == '\n')
+          if (p == '\n')
+          {
+            c = p;
             break; // Ignore.
+          }
 
           unget (c);
         }
@@ -836,7 +876,7 @@ namespace build2
         return r; // Not a space.
       }
 
-      get ();
+      get (c);
     }
 
     return r;
@@ -5,6 +5,7 @@
 #define LIBBUILD2_LEXER_HXX
 
 #include <stack>
+#include <bitset>
 
 #include <libbutl/utf8.mxx>
 #include <libbutl/unicode.mxx>
@@ -175,8 +176,23 @@ namespace build2
       //
       const char* sep_first;
       const char* sep_second;
+
+      // Characters that may need special handling in a word in this mode
+      // (separators, escape, quotes, etc). Any other character can be
+      // appended to the lexeme as is (see word() for details). Normally
+      // calculated with special_chars().
+      //
+      std::bitset<256> special;
     };
 
+    // Return the special characters for a mode with the specified word
+    // separators (or NULL if the mode is handled in an ad hoc way, in which
+    // case all the characters are treated as special), pair separator, and
+    // quotes recognition.
+    //
+    static std::bitset<256>
+    special_chars (const char* sep_first, char sep_pair, bool quotes);
+
     token
     next_eval ();
 
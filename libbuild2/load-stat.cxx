@@ -0,0 +1,178 @@
+// file      : libbuild2/load-stat.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/load-stat.hxx>
+
+#include <libbuild2/timeline.hxx>
+
+using namespace std;
+
+namespace build2
+{
+  const char* const load_stat::activity_names[load_stat::activity_count] = {
+    "parse", "lex", "function", "process", "module", "import"};
+
+  static vector<const map<string, load_stat::entry>::value_type*>
+  sorted (const map<string, load_stat::entry>& m)
+  {
+    vector<const map<string, load_stat::entry>::value_type*> r;
+    r.reserve (m.size ());
+
+    for (const auto& p: m)
+      r.push_back (&p);
+
+    sort (r.begin (), r.end (),
+          [] (const map<string, load_stat::entry>::value_type* x,
+              const map<string, load_stat::entry>::value_type* y)
+          {
+            return x->second.total > y->second.total;
+          });
+
+    return r;
+  }
+
+  auto load_stat::
+  sorted_buildfiles () const -> vector<const map<string, entry>::value_type*>
+  {
+    return sorted (buildfiles);
+  }
+
+  auto load_stat::
+  sorted_modules () const -> vector<const map<string, entry>::value_type*>
+  {
+    return sorted (modules);
+  }
+
+  void load_stat::
+  write_json (ostream& os) const
+  {
+    os << "{\"total_ns\":" << total << ",\n\"buildfiles\":[";
+
+    bool first (true);
+    for (const auto* p: sorted_buildfiles ())
+    {
+      const entry& e (p->second);
+
+      os << (first ? "\n" : ",\n") << "{\"path\":";
+      write_json_string (os, p->first);
+      os << ",\"count\":" << e.count << ",\"total_ns\":" << e.total;
+
+      for (size_t i (0); i != activity_count; ++i)
+        os << ",\"" << activity_names[i] << "_ns\":" << e.self[i];
+
+      os << '}';
+      first = false;
+    }
+
+    os << "],\n\"modules\":[";
+
+    first = true;
+    for (const auto* p: sorted_modules ())
+    {
+      os << (first ? "\n" : ",\n") << "{\"name\":";
+      write_json_string (os, p->first);
+      os << ",\"count\":" << p->second.count
+         << ",\"total_ns\":" << p->second.total << '}';
+      first = false;
+    }
+
+    os << "]}" << '\n';
+  }
+
+  void load_stat::frame::
+  start (activity a, const path_name* bf, const string* mod)
+  {
+    outer_ = stat_->top_;
+    activity_ = a;
+
+    if (bf != nullptr)
+    {
+      entry& e (stat_->buildfiles[bf->name      ? *bf->name          :
+                                  bf->path != nullptr ? bf->path->string () :
+                                  string ()]);
+      e.count++;
+      buildfile_ = &e;
+      bframe_ = this;
+      own_ = true;
+
+      tokens_ = 0;
+      lex_samples_ = 0;
+      lex_time_ = 0;
+    }
+    else
+    {
+      buildfile_ = outer_ != nullptr ? outer_->buildfile_ : nullptr;
+      bframe_ = outer_ != nullptr ? outer_->bframe_ : nullptr;
+      own_ = false;
+    }
+
+    if (mod != nullptr)
+    {
+      entry& e (stat_->modules[*mod]);
+      e.count++;
+      module_ = &e;
+    }
+    else
+      module_ = nullptr;
+
+    nested_ = 0;
+    stat_->top_ = this;
+
+    start_ = timeline::now (); // Last to exclude the above.
+  }
+
+  void load_stat::frame::
+  stop ()
+  {
+    uint64_t t (timeline::now () - start_);
+    uint64_t s (t > nested_ ? t - nested_ : 0);
+
+    entry& b (buildfile_ != nullptr
+              ? *buildfile_
+              : stat_->buildfiles["<other>"]);
+
+    if (own_)
+    {
+      // Move the extrapolated lexing time from parse to lex. Lexing only
+      // happens while parsing so it cannot exceed the parse (self) time.
+      //
+      if (lex_samples_ != 0)
+      {
+        uint64_t l (lex_time_ * tokens_ / lex_samples_);
+
+        if (l > s)
+          l = s;
+
+        b.self[lex] += l;
+        s -= l;
+      }
+
+      b.total += t;
+    }
+
+    b.self[activity_] += s;
+
+    if (module_ != nullptr)
+      module_->total += t;
+
+    if (outer_ != nullptr)
+      outer_->nested_ += t;
+    else
+      stat_->total += t;
+
+    stat_->top_ = outer_;
+  }
+
+  void load_stat::token::
+  start ()
+  {
+    start_ = timeline::now ();
+  }
+
+  void load_stat::token::
+  stop ()
+  {
+    frame_->lex_time_ += timeline::now () - start_;
+    frame_->lex_samples_++;
+  }
+}
@@ -0,0 +1,225 @@
+// file      : libbuild2/load-stat.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_LOAD_STAT_HXX
+#define LIBBUILD2_LOAD_STAT_HXX
+
+#include <map>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/forward.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/context.hxx>
+
+#include <libbuild2/export.hxx>
+
+namespace build2
+{
+  // Time spent loading each buildfile broken down by activity (see --stat).
+  //
+  // The time is recorded with frames (see below) that are established by
+  // the parser and friends for the duration of sourcing a buildfile,
+  // calling a function, etc. The time of a frame minus the time of the
+  // frames nested in it (its self time) is attributed to the frame's
+  // activity in the innermost buildfile being loaded. So, for example, the
+  // parse time of a buildfile does not include the time spent parsing the
+  // buildfiles it includes and the import time is the time spent
+  // resolving the import (searching, bootstrapping, etc) but not loading the
+  // imported project's buildfiles, which are accounted for separately. The
+  // activities that happen outside of any buildfile (for example, booting a
+  // module while bootstrapping a project) are attributed to the <other>
+  // pseudo-buildfile.
+  //
+  // Lexing is too fine-grained to be timed with frames: reading the clock
+  // twice per token would distort the lex/parse split (and noticeably slow
+  // loading down). Instead, only every lex_sample-th token of a buildfile is
+  // timed (see token below) and, when the buildfile frame is closed, the
+  // lexing time extrapolated from these samples is moved from its parse to
+  // its lex time.
+  //
+  // The statistics is only recorded during the load phase, which is
+  // exclusive, and so no synchronization is necessary. It is collected
+  // across all the contexts that have it enabled (see context::load_stat).
+  //
+  // All times are in nanoseconds.
+  //
+  class LIBBUILD2_SYMEXPORT load_stat
+  {
+  public:
+    enum activity
+    {
+      parse,    // Parsing (what is left after subtracting everything else).
+      lex,      // Lexing (extrapolated from samples, see above).
+      function, // Function calls, excluding $process.run*().
+      process,  // $process.run*() calls.
+      module,   // Module boot and init.
+      import,   // Import resolution.
+      activity_count
+    };
+
+    static const char* const activity_names[activity_count];
+
+    struct entry
+    {
+      size_t count = 0;  // Number of times sourced/booted/etc.
+      uint64_t total = 0; // Inclusive time.
+      uint64_t self[activity_count] = {};
+    };
+
+    // Buildfile and module statistics. For modules only count (boot and
+    // init calls) and total are used.
+    //
+    std::map<string, entry> buildfiles;
+    std::map<string, entry> modules;
+
+    // Total time spent loading, that is, in the outermost frames.
+    //
+    uint64_t total = 0;
+
+    // Return buildfiles/modules sorted by the inclusive time, most
+    // expensive first.
+    //
+    vector<const std::map<string, entry>::value_type*>
+    sorted_buildfiles () const;
+
+    vector<const std::map<string, entry>::value_type*>
+    sorted_modules () const;
+
+    // Write the statistics as a JSON object. Throw io_error on failure.
+    //
+    void
+    write_json (ostream&) const;
+
+    class token;
+
+    class LIBBUILD2_SYMEXPORT frame
+    {
+    public:
+      // Activity frame.
+      //
+      frame (context& c, activity a)
+          : stat_ (recording (c) ? c.load_stat : nullptr)
+      {
+        if (stat_ != nullptr)
+          start (a, nullptr, nullptr);
+      }
+
+      // As above but for a context that may not be available (NULL).
+      //
+      frame (context* c, activity a)
+          : stat_ (c != nullptr && recording (*c) ? c->load_stat : nullptr)
+      {
+        if (stat_ != nullptr)
+          start (a, nullptr, nullptr);
+      }
+
+      // Module boot/init frame.
+      //
+      frame (context& c, const string& module)
+          : stat_ (recording (c) ? c.load_stat : nullptr)
+      {
+        if (stat_ != nullptr)
+          start (load_stat::module, nullptr, &module);
+      }
+
+      // Buildfile frame.
+      //
+      frame (context& c, const path_name& buildfile)
+          : stat_ (recording (c) ? c.load_stat : nullptr)
+      {
+        if (stat_ != nullptr)
+          start (parse, &buildfile, nullptr);
+      }
+
+      ~frame ()
+      {
+        if (stat_ != nullptr)
+          stop ();
+      }
+
+      frame (const frame&) = delete;
+      frame& operator= (const frame&) = delete;
+
+    private:
+      friend class token;
+
+      static bool
+      recording (const context& c)
+      {
+        return c.load_stat != nullptr && c.phase == run_phase::load;
+      }
+
+      void
+      start (activity, const path_name*, const string*);
+
+      void
+      stop ();
+
+      load_stat* stat_;
+      frame* outer_;
+      activity activity_;
+      entry* buildfile_; // Innermost buildfile (NULL if none).
+      frame* bframe_;    // Innermost buildfile frame (NULL if none).
+      entry* module_;
+      bool own_;         // Buildfile frame.
+      uint64_t start_;
+      uint64_t nested_;  // Time of the immediately nested frames.
+
+      // Lexing samples (buildfile frame only).
+      //
+      uint64_t tokens_;
+      uint64_t lex_samples_;
+      uint64_t lex_time_;
+    };
+
+    // Token frame. Established by the parser for the duration of lexing a
+    // token, it only reads the clock for every lex_sample-th token of the
+    // innermost buildfile being loaded.
+    //
+    static const uint64_t lex_sample = 64;
+
+    class LIBBUILD2_SYMEXPORT token
+    {
+    public:
+      explicit
+      token (context& c)
+          : frame_ (frame::recording (c) && c.load_stat->top_ != nullptr
+                    ? c.load_stat->top_->bframe_
+                    : nullptr)
+      {
+        if (frame_ != nullptr)
+        {
+          if (frame_->tokens_++ % lex_sample == 0)
+            start ();
+          else
+            frame_ = nullptr;
+        }
+      }
+
+      ~token ()
+      {
+        if (frame_ != nullptr)
+          stop ();
+      }
+
+      token (const token&) = delete;
+      token& operator= (const token&) = delete;
+
+    private:
+      void
+      start ();
+
+      void
+      stop ();
+
+      frame* frame_; // Buildfile frame if sampling, NULL otherwise.
+      uint64_t start_;
+    };
+
+  private:
+    frame* top_ = nullptr;
+  };
+}
+
+#endif // LIBBUILD2_LOAD_STAT_HXX
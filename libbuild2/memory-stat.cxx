@@ -0,0 +1,156 @@
+// file      : libbuild2/memory-stat.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/memory-stat.hxx>
+
+#include <libbuild2/scope.hxx>
+#include <libbuild2/target.hxx>
+#include <libbuild2/context.hxx>
+#include <libbuild2/function.hxx>
+#include <libbuild2/variable.hxx>
+
+using namespace std;
+
+namespace build2
+{
+  // Node overhead of the red-black tree (std::map, etc) and hash table
+  // (std::unordered_map, etc) based containers.
+  //
+  static const size_t tree_node (4 * sizeof (void*));
+  static const size_t hash_node (2 * sizeof (void*));
+
+  static void
+  count_vars (memory_stat::entry& e, const variable_map& m)
+  {
+    e.count += m.size ();
+    e.bytes += m.bytes ();
+  }
+
+  size_t memory_stat::
+  total () const
+  {
+    return targets.bytes    +
+      target_names.bytes    +
+      prerequisites.bytes   +
+      target_vars.bytes     +
+      scopes.bytes          +
+      scope_vars.bytes      +
+      variable_caches.bytes +
+      variable_pool.bytes   +
+      functions.bytes;
+  }
+
+  memory_stat
+  memory_usage (const context& ctx)
+  {
+    memory_stat r;
+
+    // Targets.
+    //
+    // The target objects themselves are allocated in the arena so we use
+    // its size rather than trying to figure out the size of each target
+    // type.
+    //
+    for (const auto& pt: ctx.targets)
+    {
+      const target& t (*pt);
+
+      r.targets.count++;
+      r.targets.bytes += sizeof (target_key) + sizeof (pt) + hash_node;
+
+      if (const string* e = t.ext ())
+        r.targets.bytes += heap_bytes (*e);
+
+      r.targets.bytes += (t.prerequisite_targets.inner.capacity () +
+                          t.prerequisite_targets.outer.capacity ()) *
+        sizeof (prerequisite_target);
+
+      r.target_types[t.type ().name]++;
+
+      const prerequisites& ps (t.prerequisites ());
+
+      r.prerequisites.count += ps.size ();
+      r.prerequisites.bytes += ps.capacity () * sizeof (prerequisite);
+
+      for (const prerequisite& p: ps)
+      {
+        memory_stat::entry e;
+        count_vars (e, p.vars);
+
+        r.prerequisites.bytes +=
+          heap_bytes (p.dir) + heap_bytes (p.out) + heap_bytes (p.name) +
+          (p.ext ? heap_bytes (*p.ext) : 0) +
+          e.bytes;
+      }
+
+      count_vars (r.target_vars, t.vars);
+      count_vars (r.target_vars, t.state.inner.vars ());
+      count_vars (r.target_vars, t.state.outer.vars ());
+    }
+
+    r.targets.bytes += ctx.target_arena.allocated ();
+
+    r.target_names.count =
+      ctx.target_dirs.size () + ctx.target_names.size ();
+    r.target_names.bytes =
+      ctx.target_dirs.bytes () + ctx.target_names.bytes ();
+
+    // Scopes.
+    //
+    r.variable_caches.count += ctx.global_override_cache.size ();
+    r.variable_caches.bytes += ctx.global_override_cache.bytes ();
+
+    for (const auto& p: ctx.scopes)
+    {
+      const scope& s (p.second);
+
+      r.scopes.count++;
+      r.scopes.bytes += sizeof (p) + tree_node + heap_bytes (p.first);
+
+      count_vars (r.scope_vars, s.vars);
+
+      for (const auto& tp: s.target_vars)
+      {
+        r.scope_vars.bytes += sizeof (tp) + tree_node;
+
+        for (const auto& pp: tp.second)
+        {
+          r.scope_vars.bytes +=
+            sizeof (pp) + tree_node + heap_bytes (pp.first);
+
+          count_vars (r.scope_vars, pp.second);
+        }
+      }
+
+      r.variable_caches.count += s.target_vars.cache.size ();
+      r.variable_caches.bytes += s.target_vars.cache.bytes ();
+
+      r.variable_caches.count += s.lookup_memo.size ();
+      r.variable_caches.bytes += s.lookup_memo.bytes ();
+
+      if (const scope::root_extra_type* re = s.root_extra.get ())
+      {
+        r.scopes.bytes += sizeof (*re);
+
+        r.variable_caches.count += re->override_cache.size ();
+        r.variable_caches.bytes += re->override_cache.bytes ();
+      }
+    }
+
+    // Variables and functions.
+    //
+    // The variable pool is keyed on the pointer to the variable name.
+    //
+    r.variable_pool.count = ctx.var_pool.size ();
+    r.variable_pool.bytes = r.variable_pool.count *
+      (sizeof (variable) + sizeof (void*) + hash_node);
+
+    for (const auto& f: ctx.functions)
+    {
+      r.functions.count++;
+      r.functions.bytes += sizeof (f) + tree_node + heap_bytes (f.first);
+    }
+
+    return r;
+  }
+}
@@ -0,0 +1,78 @@
+// file      : libbuild2/memory-stat.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_MEMORY_STAT_HXX
+#define LIBBUILD2_MEMORY_STAT_HXX
+
+#include <map>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/forward.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/export.hxx>
+
+namespace build2
+{
+  // Memory used by the build state of a context broken down by subsystem
+  // (see --stat).
+  //
+  // The numbers of bytes are approximate: they are calculated from the
+  // object sizes and the number of elements in each container assuming a
+  // typical standard library implementation (node-based maps, small string
+  // optimization, etc). Memory referenced by variable values is not
+  // included.
+  //
+  struct memory_stat
+  {
+    struct entry
+    {
+      size_t count = 0;
+      size_t bytes = 0;
+    };
+
+    entry targets;          // Targets in target_set.
+    entry target_names;     // Interned target directories and names.
+    entry prerequisites;    // Prerequisites of all the targets.
+    entry target_vars;      // Target and rule-specific variables.
+    entry scopes;           // Scopes in scope_map.
+    entry scope_vars;       // Scope and target type/pattern-specific vars.
+    entry variable_caches;  // Override, append/prepend caches, lookup memos.
+    entry variable_pool;    // Variables in variable_pool.
+    entry functions;        // Function overloads in function_map.
+
+    // Number of targets of each type.
+    //
+    std::map<string, size_t> target_types;
+
+    size_t
+    total () const;
+  };
+
+  // Calculate the memory statistics for the context. Should only be called
+  // serially.
+  //
+  LIBBUILD2_SYMEXPORT memory_stat
+  memory_usage (const context&);
+
+  // Return the approximate heap memory used by a string in addition to the
+  // object itself.
+  //
+  inline size_t
+  heap_bytes (const string& s)
+  {
+    // Assume the small string optimization for up to 15 characters.
+    //
+    size_t c (s.capacity ());
+    return c > 15 ? c + 1 : 0;
+  }
+
+  template <typename K>
+  inline size_t
+  heap_bytes (const basic_path<char, K>& p)
+  {
+    return heap_bytes (p.string ());
+  }
+}
+
+#endif // LIBBUILD2_MEMORY_STAT_HXX
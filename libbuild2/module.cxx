@@ -15,6 +15,7 @@
 #include <libbuild2/scope.hxx>
 #include <libbuild2/target.hxx>
 #include <libbuild2/variable.hxx>
+#include <libbuild2/load-stat.hxx>
 #include <libbuild2/operation.hxx>
 #include <libbuild2/diagnostics.hxx>
 
@@ -525,6 +526,8 @@ namespace build2
       return;
     }
 
+    load_stat::frame lsf (rs.ctx, mod);
+
     // Otherwise search for this module.
     //
     const module_functions& mf (
@@ -553,39 +556,6 @@ namespace build2
                bool opt,
                const variable_map& hints)
   {
-    // First see if this modules has already been inited for this project.
-    //
-    module_map& lm (rs.root_extra->modules);
-    auto i (lm.find (mod));
-    bool f (i == lm.end ());
-
-    if (f)
-    {
-      // Otherwise search for this module.
-      //
-      if (const module_functions* mf = find_module (
-            bs, mod, loc, false /* boot */, opt))
-      {
-        if (mf->boot != nullptr)
-          fail (loc) << "build system module " << mod << " should be loaded "
-                     << "during bootstrap";
-
-        i = lm.emplace (
-          mod,
-          module_state {false, false, mf->init, nullptr, loc}).first;
-      }
-    }
-    else
-    {
-      module_state& s (i->second);
-
-      if (s.boot)
-      {
-        s.boot = false;
-        f = true; // This is a first call to init.
-      }
-    }
-
     // Note: pattern-typed in context ctor as project visibility variables of
     // type bool.
     //
@@ -623,21 +593,57 @@ namespace build2
           fail (loc) << "build system module " << mod << " failed to "
                      << "configure";
       }
+
+      auto i (rs.root_extra->modules.find (mod));
+      return l && c ? &i->second : nullptr;
+    }
+
+    load_stat::frame lsf (rs.ctx, mod);
+
+    // First see if this modules has already been inited for this project.
+    //
+    module_map& lm (rs.root_extra->modules);
+    auto i (lm.find (mod));
+    bool f (i == lm.end ());
+
+    if (f)
+    {
+      // Otherwise search for this module.
+      //
+      if (const module_functions* mf = find_module (
+            bs, mod, loc, false /* boot */, opt))
+      {
+        if (mf->boot != nullptr)
+          fail (loc) << "build system module " << mod << " should be loaded "
+                     << "during bootstrap";
+
+        i = lm.emplace (
+          mod,
+          module_state {false, false, mf->init, nullptr, loc}).first;
+      }
     }
     else
     {
-      l = i != lm.end ();
+      module_state& s (i->second);
 
-      if ((c = l))
+      if (s.boot)
       {
-        module_init_extra extra {i->second.module, hints};
-        c = i->second.init (rs, bs, loc, f, opt, extra);
+        s.boot = false;
+        f = true; // This is a first call to init.
       }
+    }
+
+    l = i != lm.end ();
 
-      lv = l;
-      cv = c;
+    if ((c = l))
+    {
+      module_init_extra extra {i->second.module, hints};
+      c = i->second.init (rs, bs, loc, f, opt, extra);
     }
 
+    lv = l;
+    cv = c;
+
     return l && c ? &i->second : nullptr;
   }
 
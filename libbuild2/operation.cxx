@@ -371,6 +371,14 @@ namespace build2
       // Restore original scheduler settings.
     }
 
+    // Save the durations of the updated targets for the subsequent builds
+    // and keep track of the critical path (see durations for details).
+    //
+    if (a == perform_update_id && !ctx.dry_run_option)
+      ctx.durations.save ();
+
+    ctx.durations.executed (a, ts);
+
     // Print skip count if not zero. Note that we print it regardless of the
     // diag level since this is essentially a "summary" of all the commands
     // that we did not (and, in fact, used to originally) print.
@@ -15,6 +15,7 @@
 #include <libbuild2/target.hxx>
 #include <libbuild2/function.hxx>
 #include <libbuild2/variable.hxx>
+#include <libbuild2/load-stat.hxx>
 #include <libbuild2/filesystem.hxx>
 #include <libbuild2/diagnostics.hxx>
 #include <libbuild2/prerequisite.hxx>
@@ -240,6 +241,8 @@ namespace build2
                    target* tgt,
                    prerequisite* prq)
   {
+    load_stat::frame lsf (ctx, l.name ());
+
     path_ = &l.name ();
     lexer_ = &l;
 
@@ -1359,6 +1362,8 @@ namespace build2
 
     l5 ([&]{trace (loc) << "entering " << in;});
 
+    load_stat::frame lsf (ctx, in);
+
     if (in.path != nullptr)
       enter_buildfile (*in.path);
 
@@ -1625,6 +1630,7 @@ namespace build2
                [] (const string& s) {return s.c_str ();});
     cargs.push_back (nullptr);
 
+    process_span ps (cargs);
     process pr (run_start (3            /* verbosity */,
                            cargs,
                            0            /* stdin  */,
@@ -2608,7 +2614,12 @@ namespace build2
                 if (!e.arg.empty ())
                   args.push_back (value (e.arg));
 
-                value r (ctx.functions.call (scope_, *e.func, args, l));
+                value r;
+                {
+                  load_stat::frame lsf (ctx, load_stat::function);
+                  r = ctx.functions.call (
+                    scope_, *e.func, args, l, &call_cache (l));
+                }
 
                 // We support two types of functions: matchers and extractors:
                 // a matcher returns a statically-typed bool value while an
@@ -4197,35 +4208,76 @@ namespace build2
           include_match (move (v), move (e), a);
         };
 
-      auto process = [this, &e, &appf, sp] (path&& m,
-                                            const string& p,
-                                            bool interm)
+      // Ignore entries that start with a dot unless the pattern that
+      // matched them also starts with a dot. Also ignore directories
+      // containing the .buildignore file (ignoring the test if we don't have
+      // a sufficiently setup project root).
+      //
+      // Note that during load the search results are cached (see
+      // filesystem_cache for details) and so the filter key must capture
+      // everything (other than the start directory) the filter depends on.
+      // Outside load (for example, testscript .include during execute) the
+      // cache cannot be used since it is not thread-safe.
+      //
+      const path* bi (root_ != nullptr && root_->root_extra != nullptr
+                      ? &root_->root_extra->buildignore_file
+                      : nullptr);
+
+      filesystem_cache* fc (ctx.phase == run_phase::load
+                            ? &ctx.filesystem_cache
+                            : nullptr);
+
+      auto filter = [fc, bi, sp] (const path& m, const string& p) -> bool
       {
-        // Ignore entries that start with a dot unless the pattern that
-        // matched them also starts with a dot. Also ignore directories
-        // containing the .buildignore file (ignoring the test if we don't
-        // have a sufficiently setup project root).
-        //
         const string& s (m.string ());
-        if ((p[0] != '.' && s[path::traits_type::find_leaf (s)] == '.') ||
-            (root_ != nullptr              &&
-             root_->root_extra != nullptr  &&
-             m.to_directory ()             &&
-             exists (*sp / m / root_->root_extra->buildignore_file)))
-          return !interm;
 
-        // Note that we have to make copies of the extension since there will
-        // multiple entries for each pattern.
-        //
-        if (!interm)
-          appf (move (m).representation (), optional<string> (e));
+        if (p[0] != '.' && s[path::traits_type::find_leaf (s)] == '.')
+          return false;
+
+        if (bi != nullptr && m.to_directory ())
+        {
+          path f (*sp / m / *bi);
+
+          if (fc != nullptr ? fc->exists (f) : exists (f))
+            return false;
+        }
 
         return true;
       };
 
+      string fk ("name");
+      if (bi != nullptr)
+      {
+        fk += ' ';
+        fk += bi->string ();
+      }
+
       try
       {
-        path_search (path (move (p)), process, *sp);
+        // Note that we have to make copies of the extension since there will
+        // multiple entries for each pattern.
+        //
+        if (fc != nullptr)
+        {
+          for (const path& m: fc->search (path (move (p)), *sp, fk, filter))
+            appf (string (m.representation ()), optional<string> (e));
+        }
+        else
+          path_search (path (move (p)),
+                       [&filter, &appf, &e] (path&& m,
+                                             const string& p,
+                                             bool interm)
+                       {
+                         if (!filter (m, p))
+                           return !interm;
+
+                         if (!interm)
+                           appf (move (m).representation (),
+                                 optional<string> (e));
+
+                         return true;
+                       },
+                       *sp);
       }
       catch (const system_error& e)
       {
@@ -5395,7 +5447,11 @@ namespace build2
 
             // Note that we "move" args to call().
             //
-            result_data = ctx.functions.call (scope_, name, args, loc);
+            {
+              load_stat::frame lsf (ctx, load_stat::function);
+              result_data = ctx.functions.call (
+                scope_, name, args, loc, &call_cache (loc));
+            }
             what = "function call";
           }
           else
@@ -5528,7 +5584,8 @@ namespace build2
           {
             // This can only an untyped value.
             //
-            // @@ Could move if result == &result_data.
+            // Note that if the result is ours (see below), then we can move
+            // the value out of it.
             //
             const names& lv (cast<names> (*result));
 
@@ -5558,6 +5615,8 @@ namespace build2
               //
               concat_data.value += n.dir.representation ();
             }
+            else if (result == &result_data && concat_data.value.empty ())
+              concat_data.value = move (const_cast<name&> (n).value);
             else
               concat_data.value += n.value;
           }
@@ -5582,10 +5641,20 @@ namespace build2
           if (result->null || result->empty ())
             continue;
 
-          // @@ Could move if nv is result_data; see untypify().
+          // If the result is untyped and ours (function call result,
+          // context evaluation) rather than a reference to the variable
+          // value, then move the names out of it instead of copying them
+          // (see splice_names()).
           //
+          bool m (result == &result_data && result_data.type == nullptr);
+
           names nv_storage;
-          names_view nv (reverse (*result, nv_storage));
+          if (m)
+            nv_storage = move (result_data.as<names> ());
+
+          names_view nv (m
+                         ? names_view (nv_storage)
+                         : reverse (*result, nv_storage));
 
           count = splice_names (
             loc, nv, move (nv_storage), ns, what, pairn, pp, dp, tp);
@@ -6265,8 +6334,13 @@ namespace build2
       r = move (peek_);
       peeked_ = false;
     }
+    else if (replay_ != replay::play)
+    {
+      load_stat::token lst (ctx);
+      r = lexer_next ();
+    }
     else
-      r = replay_ != replay::play ? lexer_next () : replay_next ();
+      r = replay_next ();
 
     if (replay_ == replay::save)
       replay_data_.push_back (r);
@@ -6315,7 +6389,14 @@ namespace build2
   {
     if (!peeked_)
     {
-      peek_ = (replay_ != replay::play ? lexer_next () : replay_next ());
+      if (replay_ != replay::play)
+      {
+        load_stat::token lst (ctx);
+        peek_ = lexer_next ();
+      }
+      else
+        peek_ = replay_next ();
+
       peeked_ = true;
     }
 
@@ -12,6 +12,7 @@
 #include <libbuild2/file.hxx>
 #include <libbuild2/lexer.hxx>
 #include <libbuild2/token.hxx>
+#include <libbuild2/function.hxx>
 #include <libbuild2/variable.hxx>
 #include <libbuild2/diagnostics.hxx>
 
@@ -758,6 +759,19 @@ namespace build2
     replay_tokens replay_data_;
     size_t replay_i_;              // Position of the next token during replay.
     const path_name* replay_path_; // Path before replay began (to be restored).
+
+    // Function call site resolution caches keyed on the call location line
+    // and column (see function_map::call_cache for details). Note that the
+    // cache entry is validated on each call and so does not need to be
+    // reset.
+    //
+    std::unordered_map<uint64_t, function_map::call_cache> call_caches_;
+
+    function_map::call_cache&
+    call_cache (const location& l)
+    {
+      return call_caches_[static_cast<uint64_t> (l.line) << 32 | l.column];
+    }
   };
 }
 
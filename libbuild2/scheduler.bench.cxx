@@ -0,0 +1,411 @@
+// file      : libbuild2/scheduler.bench.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <chrono>
+#include <thread>
+
+#include <cassert>
+#include <iostream>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/scheduler.hxx>
+
+using namespace std;
+
+namespace build2
+{
+  // Usage argv[0] [-c <concurrency>] [-t <max-threads>] [-q <queue-depth>]
+  //               [-w <work>] [-s <scale>] [<benchmark>...]
+  //
+  // -c  max active threads, if unspecified or 0, then hardware concurrency
+  // -t  max total threads, if unspecified or 0, then appropriate default used
+  // -q  task queue depth, if unspecified or 0, then appropriate default used
+  // -w  amount of work performed by each task, 100 by default
+  // -s  benchmark size multiplier, 1 by default
+  //
+  // Available benchmarks (all are run if none are specified):
+  //
+  // fanout   one thread starts a large number of tasks and waits for them
+  //          to complete (for example, top-level targets or prerequisites
+  //          of an alias)
+  //
+  // tree     each task starts several subtasks and waits for them to
+  //          complete, recursively (nested match_async() of prerequisites)
+  //
+  // diamond  layered DAG where each node depends on two nodes of the
+  //          previous layer; a node is executed once by whichever task gets
+  //          to it first while others wait for its completion (diamond
+  //          dependencies in execute())
+  //
+  // oversub  chains of tasks where each waits for its subtask without
+  //          working its own queue (work_none) so that the waiters are
+  //          suspended and helper threads have to be created beyond max
+  //          active threads
+  //
+  // For each benchmark we report the number of tasks executed per second,
+  // the wakeup latency percentiles (the time between the last awaited task
+  // completing and the waiting thread continuing), and the scheduler
+  // statistics counters. Each benchmark uses its own scheduler instance.
+  //
+  // See scheduler.test.cxx for notes on getting reproducible numbers.
+  //
+  static inline uint64_t
+  now ()
+  {
+    using namespace chrono;
+
+    return static_cast<uint64_t> (
+      duration_cast<nanoseconds> (
+        steady_clock::now ().time_since_epoch ()).count ());
+  }
+
+  // Set the value to the maximum of its current value and the specified
+  // one.
+  //
+  static inline void
+  update_max (atomic<uint64_t>& v, uint64_t n)
+  {
+    for (uint64_t o (v.load (memory_order_relaxed));
+         o < n &&
+           !v.compare_exchange_weak (o, n, memory_order_relaxed); ) ;
+  }
+
+  // Wakeup latency samples. Recording a sample is lock-free and once the
+  // capacity is exhausted further samples are dropped.
+  //
+  class latencies
+  {
+  public:
+    explicit
+    latencies (size_t n): samples_ (n) {}
+
+    void
+    record (uint64_t ns)
+    {
+      size_t i (n_.fetch_add (1, memory_order_relaxed));
+      if (i < samples_.size ())
+        samples_[i] = ns;
+    }
+
+    size_t
+    size () const
+    {
+      return min (n_.load (memory_order_relaxed), samples_.size ());
+    }
+
+    // Return the specified percentile in nanoseconds. Should only be called
+    // after all the samples have been recorded.
+    //
+    uint64_t
+    percentile (size_t p)
+    {
+      size_t n (size ());
+      if (n == 0)
+        return 0;
+
+      if (!sorted_)
+      {
+        sort (samples_.begin (), samples_.begin () + n);
+        sorted_ = true;
+      }
+
+      return samples_[min ((n * p) / 100, n - 1)];
+    }
+
+  private:
+    vector<uint64_t> samples_;
+    atomic<size_t> n_ {0};
+    bool sorted_ = false;
+  };
+
+  struct bench
+  {
+    scheduler& s;
+    uint64_t work;
+    latencies& lat;
+    atomic<size_t> tasks {0};
+  };
+
+  // Simulate the task's own work.
+  //
+  static void
+  spin (bench& b)
+  {
+    volatile uint64_t r (0);
+    for (uint64_t i (0); i != b.work; ++i)
+      r = r + i * i;
+
+    b.tasks.fetch_add (1, memory_order_relaxed);
+  }
+
+  // fanout
+  //
+  static void
+  fanout (bench& b, size_t width, size_t rounds)
+  {
+    for (size_t r (0); r != rounds; ++r)
+    {
+      scheduler::atomic_count tc (0);
+      atomic<uint64_t> last (0);
+
+      for (size_t i (0); i != width; ++i)
+      {
+        b.s.async (tc,
+                   [] (bench& b, atomic<uint64_t>& last)
+                   {
+                     spin (b);
+                     update_max (last, now ());
+                   },
+                   ref (b),
+                   ref (last));
+      }
+
+      b.s.wait (tc);
+      b.lat.record (now () - last.load (memory_order_relaxed));
+    }
+  }
+
+  // tree
+  //
+  static void
+  tree_node (bench& b,
+             size_t width, size_t depth,
+             atomic<uint64_t>& parent,
+             scheduler::work_queue wq)
+  {
+    if (depth != 0)
+    {
+      scheduler::atomic_count tc (0);
+      atomic<uint64_t> last (0);
+
+      for (size_t i (0); i != width; ++i)
+        b.s.async (tc, tree_node, ref (b), width, depth - 1, ref (last), wq);
+
+      b.s.wait (tc, wq);
+      b.lat.record (now () - last.load (memory_order_relaxed));
+    }
+
+    spin (b);
+    update_max (parent, now ());
+  }
+
+  static void
+  tree (bench& b, size_t width, size_t depth, size_t rounds,
+        scheduler::work_queue wq = scheduler::work_all)
+  {
+    for (size_t r (0); r != rounds; ++r)
+    {
+      atomic<uint64_t> last (0);
+      tree_node (b, width, depth, last, wq);
+    }
+  }
+
+  // oversub
+  //
+  static void
+  oversub (bench& b, size_t chains, size_t depth, size_t rounds)
+  {
+    for (size_t r (0); r != rounds; ++r)
+    {
+      scheduler::atomic_count tc (0);
+      atomic<uint64_t> last (0);
+
+      for (size_t i (0); i != chains; ++i)
+        b.s.async (tc,
+                   tree_node,
+                   ref (b),
+                   1, depth,
+                   ref (last),
+                   scheduler::work_none);
+
+      b.s.wait (tc);
+      b.lat.record (now () - last.load (memory_order_relaxed));
+    }
+  }
+
+  // diamond
+  //
+  // Use the same task count protocol as targets during execute (see
+  // target::offset_* for details).
+  //
+  static const size_t node_executed (1);
+  static const size_t node_applied  (2);
+  static const size_t node_busy     (3);
+
+  struct node
+  {
+    scheduler::atomic_count state {node_applied};
+    uint64_t finished = 0; // Set before state becomes executed.
+    vector<node*> deps;
+  };
+
+  static void
+  execute_node (bench& b, node& n)
+  {
+    // Start asynchronous execution of the dependencies that nobody has
+    // started yet.
+    //
+    scheduler::atomic_count tc (0);
+
+    for (node* d: n.deps)
+    {
+      size_t e (node_applied);
+      if (d->state.compare_exchange_strong (e,
+                                            node_busy,
+                                            memory_order_acq_rel,
+                                            memory_order_acquire))
+        b.s.async (tc, execute_node, ref (b), ref (*d));
+    }
+
+    b.s.wait (tc);
+
+    // Now wait for those that are still being executed by others.
+    //
+    for (node* d: n.deps)
+    {
+      if (d->state.load (memory_order_acquire) != node_executed)
+      {
+        b.s.wait (node_executed, d->state, scheduler::work_none);
+        b.lat.record (now () - d->finished);
+      }
+    }
+
+    spin (b);
+
+    n.finished = now ();
+    n.state.store (node_executed, memory_order_release);
+    b.s.resume (n.state);
+  }
+
+  static void
+  diamond (bench& b, size_t width, size_t layers, size_t rounds)
+  {
+    for (size_t r (0); r != rounds; ++r)
+    {
+      vector<node> ns (width * layers);
+
+      for (size_t l (1); l != layers; ++l)
+      {
+        for (size_t i (0); i != width; ++i)
+        {
+          node& n (ns[l * width + i]);
+          n.deps.push_back (&ns[(l - 1) * width + i]);
+          n.deps.push_back (&ns[(l - 1) * width + (i + 1) % width]);
+        }
+      }
+
+      node root;
+      for (size_t i (0); i != width; ++i)
+        root.deps.push_back (&ns[(layers - 1) * width + i]);
+
+      root.state.store (node_busy, memory_order_relaxed);
+      execute_node (b, root);
+    }
+  }
+
+  int
+  main (int argc, char* argv[])
+  {
+    size_t max_active (0);
+    size_t max_threads (0);
+    size_t queue_depth (0);
+    uint64_t work (100);
+    size_t scale (1);
+
+    strings benches;
+
+    for (int i (1); i != argc; ++i)
+    {
+      string a (argv[i]);
+
+      if (a == "-c")
+        max_active = stoul (argv[++i]);
+      else if (a == "-t")
+        max_threads = stoul (argv[++i]);
+      else if (a == "-q")
+        queue_depth = stoul (argv[++i]);
+      else if (a == "-w")
+        work = stoull (argv[++i]);
+      else if (a == "-s")
+        scale = stoul (argv[++i]);
+      else if (a == "fanout" || a == "tree" || a == "diamond" || a == "oversub")
+        benches.push_back (move (a));
+      else
+        assert (false);
+    }
+
+    if (max_active == 0)
+      max_active = scheduler::hardware_concurrency ();
+
+    if (benches.empty ())
+      benches = {"fanout", "tree", "diamond", "oversub"};
+
+    for (const string& n: benches)
+    {
+      // Oversubscription needs a thread for each suspended waiter (there
+      // are 32 chains 16 deep).
+      //
+      size_t mt (max_threads);
+      if (mt == 0 && n == "oversub")
+        mt = max_active + 32 * 17;
+
+      scheduler s (max_active, 1, mt, queue_depth);
+
+      latencies lat (1024 * 1024);
+      bench b {s, work, lat};
+
+      // Note that the scheduler caches the thread's task queue in TLS so
+      // each instance has to be driven from a new thread.
+      //
+      uint64_t start (now ());
+
+      thread t ([&b, &n, scale] ()
+                {
+                  if      (n == "fanout")  fanout  (b, 1000, 100 * scale);
+                  else if (n == "tree")    tree    (b, 4, 7, 2 * scale);
+                  else if (n == "diamond") diamond (b, 64, 64, 10 * scale);
+                  else if (n == "oversub") oversub (b, 32, 16, 10 * scale);
+                });
+      t.join ();
+
+      uint64_t end (now ());
+
+      scheduler::stat st (s.shutdown ());
+
+      size_t tasks (b.tasks.load (memory_order_relaxed));
+      double sec ((end - start) / 1e9);
+
+      cout << n << endl
+           << "  tasks                  " << tasks                     << endl
+           << "  time_ms                " << (end - start) / 1000000   << endl
+           << "  tasks_per_sec          "
+           << static_cast<uint64_t> (sec != 0 ? tasks / sec : 0)      << endl
+           << "  wakeup_samples         " << lat.size ()               << endl
+           << "  wakeup_p50_us          " << lat.percentile (50) / 1000 << endl
+           << "  wakeup_p90_us          " << lat.percentile (90) / 1000 << endl
+           << "  wakeup_p99_us          " << lat.percentile (99) / 1000 << endl
+           << "  wakeup_max_us          " << lat.percentile (100) / 1000 << endl
+           << endl
+           << "  thread_max_active      " << st.thread_max_active     << endl
+           << "  thread_max_total       " << st.thread_max_total      << endl
+           << "  thread_helpers         " << st.thread_helpers        << endl
+           << "  thread_max_waiting     " << st.thread_max_waiting    << endl
+           << "  task_queue_depth       " << st.task_queue_depth      << endl
+           << "  task_queue_full        " << st.task_queue_full       << endl
+           << "  wait_queue_slots       " << st.wait_queue_slots      << endl
+           << "  wait_queue_collisions  " << st.wait_queue_collisions << endl
+           << "  wait_spin_hits         " << st.wait_spin_hits        << endl
+           << endl;
+    }
+
+    return 0;
+  }
+}
+
+int
+main (int argc, char* argv[])
+{
+  return build2::main (argc, argv);
+}
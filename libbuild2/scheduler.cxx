@@ -20,6 +20,8 @@
 
 #include <cerrno>
 
+#include <libbuild2/timeline.hxx>
+#include <libbuild2/jobserver.hxx>
 #include <libbuild2/diagnostics.hxx>
 
 using namespace std;
@@ -71,9 +73,9 @@ namespace build2
       //
       if (task_queue* tq = queue ())
       {
-        for (lock ql (tq->mutex); !tq->shutdown && !empty_back (*tq); )
+        while (!tq->shutdown.load (memory_order_relaxed) && !empty_back (*tq))
         {
-          pop_back (*tq, ql);
+          pop_back (*tq);
 
           if (wq == work_one)
           {
@@ -91,6 +93,24 @@ namespace build2
       }
     }
 
+    // Before suspending, spin for a short while in case the task count is
+    // about to be decremented (for example, by a helper finishing the last
+    // task). Suspending is expensive: it may activate another helper (or
+    // even create a new thread) only for us to become ready again a moment
+    // later and have to wait for an active slot. Note that we remain active
+    // while spinning so we keep it short and yield our timeslice.
+    //
+    for (size_t i (0); i != wait_spin_count; ++i)
+    {
+      this_thread::yield ();
+
+      if ((tc = task_count.load (memory_order_acquire)) <= start_count)
+      {
+        stat_wait_spins_.fetch_add (1, memory_order_relaxed);
+        return tc;
+      }
+    }
+
     return suspend (start_count, task_count);
   }
 
@@ -103,6 +123,7 @@ namespace build2
     lock l (mutex_);
 
     active_--;
+    release_token ();
     waiting_++;
     if (external)
       external_++;
@@ -153,8 +174,22 @@ namespace build2
     ready_++;
     progress_.fetch_add (1, memory_order_relaxed);
 
-    while (!shutdown_ && active_ >= max_active_)
-      ready_condv_.wait (l);
+    while (!shutdown_)
+    {
+      if (active_ < max_active_)
+      {
+        if (acquire_token ())
+          break;
+
+        // Nobody will notify us when a jobserver token becomes available so
+        // we have to poll (but we will also be woken up if one of our
+        // threads becomes inactive).
+        //
+        ready_condv_.wait_for (l, chrono::milliseconds (10));
+      }
+      else
+        ready_condv_.wait (l);
+    }
 
     ready_--;
     active_++;
@@ -164,6 +199,28 @@ namespace build2
       throw_generic_error (ECANCELED);
   }
 
+  bool scheduler::
+  acquire_token ()
+  {
+    // The first active thread uses the implicit token.
+    //
+    if (jobserver_ == nullptr || jobserver_->acquired () >= active_)
+      return true;
+
+    return jobserver_->try_acquire ();
+  }
+
+  void scheduler::
+  release_token ()
+  {
+    if (jobserver_ != nullptr)
+    {
+      for (size_t n (active_ != 0 ? active_ - 1 : 0);
+           jobserver_->acquired () > n; )
+        jobserver_->release ();
+    }
+  }
+
   void scheduler::
   sleep (const duration& d)
   {
@@ -192,6 +249,8 @@ namespace build2
       wait_queue_[
         hash<const atomic_count*> () (&task_count) % wait_queue_size_]);
 
+    uint64_t ts (build_timeline != nullptr ? timeline::now () : 0);
+
     // This thread is no longer active.
     //
     deactivate (false /* external */);
@@ -204,12 +263,15 @@ namespace build2
     size_t tc (0);
     bool collision;
     {
+      wait_waiter w;
+      w.task_count = &task_count;
+
       lock l (s.mutex);
 
       // We have a collision if there is already a waiter for a different
       // task count.
       //
-      collision = (s.waiters++ != 0 && s.task_count != &task_count);
+      collision = (s.waiters != nullptr && s.task_count != &task_count);
 
       // This is nuanced: we want to always have the task count of the last
       // thread to join the queue. Otherwise, if threads are leaving and
@@ -218,21 +280,36 @@ namespace build2
       //
       s.task_count = &task_count;
 
+      w.prev = nullptr;
+      w.next = s.waiters;
+      if (w.next != nullptr)
+        w.next->prev = &w;
+      s.waiters = &w;
+
       // We could probably relax the atomic access since we use a mutex for
       // synchronization though this has a different tradeoff (calling wait
       // because we don't see the count).
       //
       while (!(s.shutdown ||
                (tc = task_count.load (memory_order_acquire)) <= start_count))
-        s.condv.wait (l);
+        w.condv.wait (l);
+
+      if (w.prev != nullptr)
+        w.prev->next = w.next;
+      else
+        s.waiters = w.next;
 
-      s.waiters--;
+      if (w.next != nullptr)
+        w.next->prev = w.prev;
     }
 
     // This thread is no longer waiting.
     //
     activate (false /* external */, collision);
 
+    if (ts != 0)
+      build_timeline->complete ("scheduler", "wait", ts, timeline::now ());
+
     return tc;
   }
 
@@ -245,12 +322,17 @@ namespace build2
     wait_slot& s (
       wait_queue_[hash<const atomic_count*> () (&tc) % wait_queue_size_]);
 
-    // See suspend() for why we must hold the lock.
+    // See suspend() for why we must hold the lock. Note also that the
+    // waiter cannot unlink itself (and go out of scope) while we are holding
+    // it.
     //
     lock l (s.mutex);
 
-    if (s.waiters != 0)
-      s.condv.notify_all ();
+    for (wait_waiter* w (s.waiters); w != nullptr; w = w->next)
+    {
+      if (w->task_count == &tc)
+        w->condv.notify_one ();
+    }
   }
 
   scheduler::
@@ -337,7 +419,8 @@ namespace build2
            size_t init_active,
            size_t max_threads,
            size_t queue_depth,
-           optional<size_t> max_stack)
+           optional<size_t> max_stack,
+           build2::jobserver* js)
   {
     // Lock the mutex to make sure our changes are visible in (other) active
     // threads.
@@ -345,6 +428,7 @@ namespace build2
     lock l (mutex_);
 
     max_stack_ = max_stack;
+    jobserver_ = max_active != 1 ? js : nullptr;
 
     // Use 8x max_active on 32-bit and 32x max_active on 64-bit. Unless we
     // were asked to run serially.
@@ -371,10 +455,20 @@ namespace build2
     // test execution). If the tasks are quick then the synchronization
     // overhead required for queuing/dequeuing things starts to dominate.
     //
+    // Note also that the depth is rounded up to a power of two (see
+    // task_queue for details).
+    //
     task_queue_depth_ = queue_depth != 0
       ? queue_depth
       : max_active * 4;
 
+    {
+      size_t d (1);
+      while (d < task_queue_depth_)
+        d <<= 1;
+      task_queue_depth_ = d;
+    }
+
     queued_task_count_.store (0, memory_order_relaxed);
 
     if ((wait_queue_size_ = max_threads == 1 ? 0 : shard_size ()) != 0)
@@ -384,6 +478,7 @@ namespace build2
     //
     stat_max_waiters_     = 0;
     stat_wait_collisions_ = 0;
+    stat_wait_spins_.store (0, memory_order_relaxed);
 
     progress_.store (0, memory_order_relaxed);
 
@@ -456,9 +551,8 @@ namespace build2
 
       for (task_queue& tq: task_queues_)
       {
-        lock ql (tq.mutex);
-        r.task_queue_full += tq.stat_full;
-        tq.shutdown = true;
+        r.task_queue_full += tq.stat_full.load (memory_order_relaxed);
+        tq.shutdown.store (true, memory_order_relaxed);
       }
 
       // Wait for all the helpers to terminate waking up any thread that
@@ -479,8 +573,16 @@ namespace build2
           ready_condv_.notify_all ();
 
         if (w)
+        {
           for (size_t i (0); i != wait_queue_size_; ++i)
-            wait_queue_[i].condv.notify_all ();
+          {
+            wait_slot& ws (wait_queue_[i]);
+            lock l (ws.mutex);
+
+            for (wait_waiter* w (ws.waiters); w != nullptr; w = w->next)
+              w->condv.notify_one ();
+          }
+        }
 
         this_thread::yield ();
         l.lock ();
@@ -488,6 +590,12 @@ namespace build2
 
       assert (external_ == 0);
 
+      // Return the jobserver tokens, if any (normally there should be none
+      // left at this point).
+      //
+      release_token ();
+      jobserver_ = nullptr;
+
       // Wait for the deadlock monitor (the only remaining thread).
       //
       if (orig_max_active_ != 1) // See tune() for why not max_active_.
@@ -511,6 +619,8 @@ namespace build2
 
       r.wait_queue_slots      = wait_queue_size_;
       r.wait_queue_collisions = stat_wait_collisions_;
+      r.wait_spin_hits        = stat_wait_spins_.load (
+        memory_order_relaxed);
     }
 
     return r;
@@ -749,7 +859,7 @@ namespace build2
       // If there is a spare active thread, become active and go looking for
       // some work.
       //
-      if (s.active_ < s.max_active_)
+      if (s.active_ < s.max_active_ && s.acquire_token ())
       {
         s.active_++;
 
@@ -769,8 +879,8 @@ namespace build2
           {
             task_queue& tq (*it);
 
-            for (lock ql (tq.mutex); !tq.shutdown && !s.empty_front (tq); )
-              s.pop_front (tq, ql);
+            while (!tq.shutdown.load (memory_order_relaxed) &&
+                   s.pop_front (tq)) ;
 
             if (++i == n)
               break;
@@ -780,6 +890,7 @@ namespace build2
         }
 
         s.active_--;
+        s.release_token ();
 
         // While executing the tasks a thread might have become ready
         // (equivalent logic to deactivate()).
@@ -812,7 +923,7 @@ namespace build2
       lock l (mutex_);
       task_queues_.emplace_back (task_queue_depth_);
       tq = &task_queues_.back ();
-      tq->shutdown = shutdown_;
+      tq->shutdown.store (shutdown_, memory_order_relaxed);
     }
 
     queue (tq);
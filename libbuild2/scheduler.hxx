@@ -18,6 +18,8 @@
 
 namespace build2
 {
+  class jobserver;
+
   // Scheduler of tasks and threads. Works best for "substantial" tasks (e.g.,
   // running a process), where in comparison thread synchronization overhead
   // is negligible.
@@ -45,6 +47,11 @@ namespace build2
   // helper is suspended) or the helper becoming available to perform another
   // task.
   //
+  // If a jobserver is specified, then each active thread besides the first
+  // must also hold a token acquired from the jobserver. This allows us to
+  // share the concurrency with an outer GNU make (or build system) as well
+  // as with the processes we start.
+  //
   // Note that suspended threads are not reused as helpers. Rather, a new
   // helper thread is always created if none is available. This is done to
   // allow a ready master to continue as soon as possible. If it were reused
@@ -179,14 +186,23 @@ namespace build2
     // If the maximum threads or task queue depth arguments are unspecified,
     // then appropriate defaults are used.
     //
+    // If the jobserver is specified, then it should remain alive until the
+    // scheduler is shut down.
+    //
     explicit
     scheduler (size_t max_active,
                size_t init_active = 1,
                size_t max_threads = 0,
                size_t queue_depth = 0,
-               optional<size_t> max_stack = nullopt)
+               optional<size_t> max_stack = nullopt,
+               build2::jobserver* js = nullptr)
     {
-      startup (max_active, init_active, max_threads, queue_depth, max_stack);
+      startup (max_active,
+               init_active,
+               max_threads,
+               queue_depth,
+               max_stack,
+               js);
     }
 
     // Start the scheduler.
@@ -196,7 +212,8 @@ namespace build2
              size_t init_active = 1,
              size_t max_threads = 0,
              size_t queue_depth = 0,
-             optional<size_t> max_stack = nullopt);
+             optional<size_t> max_stack = nullopt,
+             build2::jobserver* = nullptr);
 
     // Return true if the scheduler was started up.
     //
@@ -271,7 +288,9 @@ namespace build2
       size_t task_queue_remain     = 0; // # of tasks remaining in queue.
 
       size_t wait_queue_slots      = 0; // # of wait slots (buckets).
-      size_t wait_queue_collisions = 0; // # of times slot had been occupied.
+      size_t wait_queue_collisions = 0; // # of times slot had been occupied
+                                        // by a different task count.
+      size_t wait_spin_hits        = 0; // # of waits satisfied by spinning.
     };
 
     stat
@@ -396,6 +415,22 @@ namespace build2
     size_t
     suspend (size_t start_count, const atomic_count& task_count);
 
+    // Number of times wait() re-checks the task count (yielding in between)
+    // before suspending the thread.
+    //
+    static const size_t wait_spin_count = 16;
+
+    // Jobserver token accounting. Call acquire_token() before incrementing
+    // the active count and release_token() after decrementing it. Return
+    // false if the thread cannot become active because no token is
+    // available. Expect the scheduler mutex to be locked.
+    //
+    bool
+    acquire_token ();
+
+    void
+    release_token ();
+
     // Task encapsulation.
     //
     template <typename F, typename... A>
@@ -417,9 +452,11 @@ namespace build2
       }
     };
 
+    struct task_data;
+
     template <typename F, typename... A>
     static void
-    task_thunk (scheduler&, lock&, void*);
+    task_thunk (scheduler&, task_data&);
 
     template <typename T>
     static std::decay_t<T>
@@ -438,6 +475,8 @@ namespace build2
 
     optional<size_t> max_stack_;
 
+    build2::jobserver* jobserver_ = nullptr;
+
     // The constraints that we must maintain:
     //
     //                  active <= max_active
@@ -480,6 +519,7 @@ namespace build2
     //
     size_t stat_max_waiters_;
     size_t stat_wait_collisions_;
+    atomic_count stat_wait_spins_; // Updated without the lock.
 
     // Progress counter.
     //
@@ -501,23 +541,34 @@ namespace build2
 
     // Wait queue.
     //
-    // A wait slot blocks a bunch of threads. When they are (all) unblocked,
-    // they re-examine their respective conditions and either carry on or
-    // block again.
+    // Each waiting thread parks on its own condition variable which is
+    // linked into a wait slot. When the task count is resumed, only the
+    // threads waiting on this task count are woken up (that is, similar to
+    // a futex, the wait is on the task count itself rather than on the
+    // slot).
     //
     // The wait queue is a shard of slots. A thread picks a slot based on the
     // address of its task count variable. How many slots do we need? This
     // depends on the number of waiters that we can have which cannot be
-    // greater than the total number of threads.
+    // greater than the total number of threads. Note that while slot
+    // collisions no longer cause spurious wakeups, they still result in
+    // contention on the slot mutex.
     //
     // The pointer to the task count is used to identify the already waiting
     // group of threads for collision statistics.
     //
+    struct wait_waiter
+    {
+      const atomic_count* task_count;
+      std::condition_variable condv;
+      wait_waiter* prev;
+      wait_waiter* next;
+    };
+
     struct wait_slot
     {
       std::mutex mutex;
-      std::condition_variable condv;
-      size_t waiters = 0;
+      wait_waiter* waiters = nullptr; // Doubly-linked list.
       const atomic_count* task_count;
       bool shutdown = true;
     };
@@ -527,18 +578,26 @@ namespace build2
 
     // Task queue.
     //
-    // Each queue has its own mutex plus we have an atomic total count of the
-    // queued tasks. Note that it should only be modified while holding one
-    // of the queue locks.
+    // Each queue is a lock-free work-stealing deque (Chase-Lev) plus we have
+    // an atomic total count of the queued tasks. Note that the count is
+    // incremented before a task is made visible to other threads and
+    // decremented once it has been claimed. As a result, it may temporarily
+    // be greater (but never less) than the actual number of queued tasks.
     //
     atomic_count queued_task_count_;
 
     // For now we only support trivially-destructible tasks.
     //
+    // The busy flag is set when the task is pushed and cleared by whomever
+    // claimed it once the task data has been moved out of the slot. The
+    // queue owner should not reuse the slot until then (a thief that has
+    // claimed the slot may still be reading it).
+    //
     struct task_data
     {
       std::aligned_storage<sizeof (void*) * 8>::type data;
-      void (*thunk) (scheduler&, lock&, void*);
+      void (*thunk) (scheduler&, task_data&);
+      std::atomic<bool> busy {false};
     };
 
     // We have two requirements: Firstly, we want to keep the master thread
@@ -563,150 +622,198 @@ namespace build2
     // of the first task it has queued at this "level" and makes sure it
     // doesn't try to deque any task beyond that.
     //
-    size_t task_queue_depth_; // Multiple of max_active.
+    size_t task_queue_depth_; // Multiple of max_active, power of two.
 
     struct task_queue
     {
-      std::mutex mutex;
-      bool shutdown = false;
+      std::atomic<bool> shutdown {false};
 
-      size_t stat_full = 0; // Number of times push() returned NULL.
+      atomic_count stat_full {0}; // Number of times push() returned NULL.
 
-      // Our task queue is circular with head being the index of the first
-      // element and tail -- of the last. Since this makes the empty and one
-      // element cases indistinguishable, we also keep the size.
+      // Our task queue is a circular buffer indexed with the ever-increasing
+      // top and bottom counters: top is the index of the first element and
+      // bottom -- one past the last. Only the owner thread pushes and pops at
+      // the bottom while any thread can steal from the top. Since the depth
+      // is a power of two, the counters wrapping around is harmless.
       //
-      // The mark is an index somewhere between (figuratively speaking) head
-      // and tail, if enabled. If the mark is hit, then it is disabled until
-      // the queue becomes empty or it is reset by a push.
+      // The mark is the index of the first element the owner is allowed to
+      // pop from the back, if enabled. Because the indexes are never reused
+      // (modulo wrap-around), there is no need to adjust it when elements
+      // are stolen from the front. The mark is only accessed by the owner
+      // thread.
       //
-      size_t head = 0;
-      size_t mark = 0;
-      size_t tail = 0;
-      size_t size = 0;
+      atomic_count top    {0};
+      atomic_count bottom {0};
+
+      optional<size_t> mark;
 
       unique_ptr<task_data[]> data;
 
-      task_queue (size_t depth): data (new task_data[depth]) {}
+      task_queue (size_t depth): mark (0), data (new task_data[depth]) {}
     };
 
-    // Task queue API. Expects the queue mutex to be locked.
+    // Task queue API.
     //
+    // Note that the signed difference of two indexes is used to compare them
+    // in order to handle the wrap-around.
+    //
+    static std::ptrdiff_t
+    index_diff (size_t x, size_t y)
+    {
+      return static_cast<std::ptrdiff_t> (x - y);
+    }
 
-    // Push a new task to the queue returning a pointer to the task data to be
-    // filled or NULL if the queue is full.
+    // Reserve a slot for a new task at the back of the queue returning a
+    // pointer to the task data to be filled or NULL if the queue is full.
+    // Once filled, the task should be made available with publish(). Can
+    // only be called by the queue owner.
     //
     task_data*
     push (task_queue& tq)
     {
-      size_t& s (tq.size);
-      size_t& t (tq.tail);
-      size_t& m (tq.mark);
+      size_t b (tq.bottom.load (memory_order_relaxed));
+      size_t t (tq.top.load (memory_order_acquire));
 
-      if (s != task_queue_depth_)
-      {
-        //                                         normal  wrap empty
-        //                                         |       |    |
-        t = s != 0 ? (t != task_queue_depth_ - 1 ? t + 1 : 0) : t;
-        s++;
+      if (b - t >= task_queue_depth_)
+        return nullptr;
 
-        if (m == task_queue_depth_) // Enable the mark if first push.
-          m = t;
+      // The slot could still be read by a thief that has claimed it (see
+      // task_data for details), in which case treat the queue as full.
+      //
+      task_data& td (tq.data[b & (task_queue_depth_ - 1)]);
+      if (td.busy.load (memory_order_acquire))
+        return nullptr;
 
-        queued_task_count_.fetch_add (1, std::memory_order_release);
-        return &tq.data[t];
-      }
+      if (!tq.mark) // Enable the mark if first push.
+        tq.mark = b;
 
-      return nullptr;
+      return &td;
     }
 
-    bool
-    empty_front (task_queue& tq) const {return tq.size == 0;}
-
     void
-    pop_front (task_queue& tq, lock& ql)
+    publish (task_queue& tq)
     {
-      size_t& s (tq.size);
-      size_t& h (tq.head);
-      size_t& m (tq.mark);
+      size_t b (tq.bottom.load (memory_order_relaxed));
+      tq.data[b & (task_queue_depth_ - 1)].busy.store (true,
+                                                       memory_order_relaxed);
 
-      bool a (h == m); // Adjust mark?
-      task_data& td (tq.data[h]);
+      queued_task_count_.fetch_add (1, memory_order_release);
+      tq.bottom.store (b + 1, memory_order_release);
+    }
 
-      //                                         normal  wrap empty
-      //                                         |       |    |
-      h = s != 1 ? (h != task_queue_depth_ - 1 ? h + 1 : 0) : h;
+    // Steal a task from the front of the queue and execute it. Return false
+    // if the queue is empty. Can be called by any thread.
+    //
+    bool
+    pop_front (task_queue& tq)
+    {
+      for (;;)
+      {
+        size_t t (tq.top.load (memory_order_acquire));
+        std::atomic_thread_fence (memory_order_seq_cst);
+        size_t b (tq.bottom.load (memory_order_acquire));
 
-      if (--s == 0 || a)
-        m = h; // Reset or adjust the mark.
+        if (index_diff (b, t) <= 0)
+          return false;
 
-      execute (ql, td);
+        // If we lost the race (to another thief or to the owner popping the
+        // last element), then re-examine the queue.
+        //
+        if (tq.top.compare_exchange_strong (t, t + 1,
+                                            memory_order_seq_cst,
+                                            memory_order_relaxed))
+        {
+          execute (tq.data[t & (task_queue_depth_ - 1)]);
+          return true;
+        }
+      }
     }
 
+    // Return true if there is nothing the owner can pop from the back. Can
+    // only be called by the queue owner.
+    //
     bool
     empty_back (task_queue& tq) const
     {
-      return tq.size == 0 || tq.mark == task_queue_depth_;
+      if (!tq.mark)
+        return true;
+
+      size_t b (tq.bottom.load (memory_order_relaxed));
+      size_t t (tq.top.load (memory_order_acquire));
+
+      return index_diff (b, t) <= 0 || index_diff (b - 1, *tq.mark) < 0;
     }
 
-    void
-    pop_back (task_queue& tq, lock& ql)
+    // Pop a task from the back of the queue (but not beyond the mark) and
+    // execute it. Return false if there was nothing to pop. Can only be
+    // called by the queue owner.
+    //
+    bool
+    pop_back (task_queue& tq)
     {
-      size_t& s (tq.size);
-      size_t& t (tq.tail);
-      size_t& m (tq.mark);
+      if (!tq.mark)
+        return false;
+
+      size_t b (tq.bottom.load (memory_order_relaxed) - 1);
 
-      bool a (t == m); // Adjust mark?
+      if (index_diff (b, *tq.mark) < 0)
+        return false;
 
-      task_data& td (tq.data[t]);
+      tq.bottom.store (b, memory_order_relaxed);
+      std::atomic_thread_fence (memory_order_seq_cst);
+      size_t t (tq.top.load (memory_order_relaxed));
+
+      std::ptrdiff_t n (index_diff (b, t));
+
+      if (n < 0) // Empty.
+      {
+        tq.bottom.store (b + 1, memory_order_relaxed);
+        return false;
+      }
+
+      if (n == 0) // Last element, race against thieves.
+      {
+        bool w (tq.top.compare_exchange_strong (t, t + 1,
+                                                memory_order_seq_cst,
+                                                memory_order_relaxed));
+        tq.bottom.store (b + 1, memory_order_relaxed);
+
+        if (!w)
+          return false;
+      }
+
+      bool a (b == *tq.mark); // Popping the mark?
 
       // Save the old queue mark and disable it in case the task we are about
       // to run adds sub-tasks. The first push(), if any, will reset it.
       //
-      size_t om (m);
-      m = task_queue_depth_;
-
-      //                     normal  wrap                     empty
-      //                     |       |                        |
-      t = s != 1 ? (t != 0 ? t - 1 : task_queue_depth_ - 1) : t;
-      --s;
+      optional<size_t> om (tq.mark);
+      tq.mark = nullopt;
 
-      execute (ql, td);
+      execute (tq.data[b & (task_queue_depth_ - 1)]);
 
-      // Restore the old mark (which we might have to adjust).
+      // Restore the old mark or disable it if we have popped the first task
+      // of this level. Note that if in the meantime the queue became empty
+      // (or thieves went past the old mark), then the restored mark is
+      // equivalent to the one reset to the next element.
       //
-      if (s == 0)
-        m = t;                 // Reset the mark.
-      else if (a)
-        m = task_queue_depth_; // Disable the mark.
+      if (a)
+        tq.mark = nullopt;
       else
-        // What happens if head goes past the old mark? In this case we will
-        // get into the empty queue state before we end up making any (wrong)
-        // decisions based on this value. Unfortunately there is no way to
-        // detect this (and do some sanity asserts) since things can wrap
-        // around.
-        //
-        // To put it another way, the understanding here is that after the
-        // task returns we will either have an empty queue or there will still
-        // be tasks between the old mark and the current tail, something along
-        // these lines:
-        //
-        // OOOOOXXXXOOO
-        //   |  |  |
-        //   m  h  t
-        //
-        m = om;
+        tq.mark = om;
+
+      return true;
     }
 
     void
-    execute (lock& ql, task_data& td)
+    execute (task_data& td)
     {
       queued_task_count_.fetch_sub (1, std::memory_order_release);
 
-      // The thunk moves the task data to its stack, releases the lock,
-      // and continues to execute the task.
+      // The thunk moves the task data to its stack, releases the slot, and
+      // continues to execute the task.
       //
-      td.thunk (*this, ql, &td.data);
+      td.thunk (*this, td);
 
       // See if we need to call the monitor (see also the serial version
       // in async()).
@@ -742,8 +849,6 @@ namespace build2
           }
         }
       }
-
-      ql.lock ();
     }
 
     // Each thread has its own queue which are stored in this list.
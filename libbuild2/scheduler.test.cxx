@@ -152,7 +152,8 @@ namespace build2
            << "task_queue_full        " << st.task_queue_full       << endl
            << endl
            << "wait_queue_slots       " << st.wait_queue_slots      << endl
-           << "wait_queue_collisions  " << st.wait_queue_collisions << endl;
+           << "wait_queue_collisions  " << st.wait_queue_collisions << endl
+           << "wait_spin_hits         " << st.wait_spin_hits        << endl;
     }
 
     return 0;
@@ -48,59 +48,47 @@ namespace build2
     if (tq == nullptr)
       tq = &create_queue ();
 
+    if (tq->shutdown.load (memory_order_relaxed))
+      throw_generic_error (ECANCELED);
+
+    if (task_data* td = push (*tq))
     {
-      lock ql (tq->mutex);
+      // Package the task.
+      //
+      new (&td->data) task {
+        &task_count,
+        start_count,
+        decay_copy (forward<F> (f)),
+        typename task::args_type (decay_copy (forward<A> (a))...)};
 
-      if (tq->shutdown)
-        throw_generic_error (ECANCELED);
+      td->thunk = &task_thunk<F, A...>;
 
-      if (task_data* td = push (*tq))
-      {
-        // Package the task (under lock).
-        //
-        new (&td->data) task {
-          &task_count,
-          start_count,
-          decay_copy (forward<F> (f)),
-          typename task::args_type (decay_copy (forward<A> (a))...)};
-
-        td->thunk = &task_thunk<F, A...>;
-
-        // Increment the task count. This has to be done under lock to prevent
-        // the task from decrementing the count before we had a chance to
-        // increment it.
-        //
-        task_count.fetch_add (1, std::memory_order_release);
-      }
-      else
-      {
-        tq->stat_full++;
-
-        // We have to perform the same mark adjust/restore as in pop_back()
-        // since the task we are about to execute synchronously may try to
-        // work the queue.
-        //
-        // It would have been cleaner to package all this logic into push()
-        // but that would require dragging function/argument types into it.
-        //
-        size_t& s (tq->size);
-        size_t& t (tq->tail);
-        size_t& m (tq->mark);
-
-        size_t om (m);
-        m = task_queue_depth_;
-
-        ql.unlock ();
-        forward<F> (f) (forward<A> (a)...); // Should not throw.
-
-        if (om != task_queue_depth_)
-        {
-          ql.lock ();
-          m = s == 0 ? t : om;
-        }
+      // Increment the task count. This has to be done before publishing the
+      // task to prevent it from decrementing the count before we had a
+      // chance to increment it.
+      //
+      task_count.fetch_add (1, std::memory_order_release);
 
-        return false;
-      }
+      publish (*tq);
+    }
+    else
+    {
+      tq->stat_full.fetch_add (1, memory_order_relaxed);
+
+      // We have to perform the same mark save/restore as in pop_back() since
+      // the task we are about to execute synchronously may try to work the
+      // queue.
+      //
+      // It would have been cleaner to package all this logic into push()
+      // but that would require dragging function/argument types into it.
+      //
+      optional<size_t> om (tq->mark);
+      tq->mark = nullopt;
+
+      forward<F> (f) (forward<A> (a)...); // Should not throw.
+
+      tq->mark = om;
+      return false;
     }
 
     // If there is a spare active thread, wake up (or create) the helper
@@ -119,14 +107,14 @@ namespace build2
 
   template <typename F, typename... A>
   void scheduler::
-  task_thunk (scheduler& s, lock& ql, void* td)
+  task_thunk (scheduler& s, task_data& td)
   {
     using task = task_type<F, A...>;
 
-    // Move the data and release the lock.
+    // Move the data and release the slot.
     //
-    task t (move (*static_cast<task*> (td)));
-    ql.unlock ();
+    task t (move (*static_cast<task*> (static_cast<void*> (&td.data))));
+    td.busy.store (false, memory_order_release);
 
     t.thunk (std::index_sequence_for<A...> ());
 
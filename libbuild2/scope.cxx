@@ -25,6 +25,40 @@ namespace build2
     if (var.visibility == variable_visibility::prereq)
       return make_pair (lookup_type (), d);
 
+    // Try the memo unless we are skipping initial lookups (in which case we
+    // are looking for the prepend/append stem), this is not a scope of the
+    // global build state (for example, temp_scope, changes to which are not
+    // tracked), or we are loading (in which case the memo would be
+    // invalidated by the next assignment anyway).
+    //
+    // While at it, keep track of whether the outcome is memoizable, that
+    // is, does not depend on the target name (see variable_lookup_memo for
+    // details).
+    //
+    // Note that we get the version before the lookup so that any concurrent
+    // change invalidates what we memoize.
+    //
+    bool memo (start_d == 1   &&
+               vars.global () &&
+               ctx.phase != run_phase::load);
+    bool pat (false); // Target name pattern considered.
+    variable_lookup_memo::key_type mk (&var, tt, gt);
+    size_t mv (ctx.global_vars_version.load (memory_order_acquire));
+
+    if (memo)
+    {
+      if (const auto* r = lookup_memo.find (mk, mv))
+        return *r;
+    }
+
+    auto memoize = [&memo, &pat, &mk, mv, this] (pair<lookup_type, size_t>&& r)
+    {
+      if (memo && !pat)
+        lookup_memo.insert (ctx, mk, mv, r);
+
+      return move (r);
+    };
+
     // Process target type/pattern-specific prepend/append values.
     //
     auto pre_app = [&var, this] (lookup_type& l,
@@ -114,14 +148,17 @@ namespace build2
         {
           if (f)
           {
-            lookup_type l (s->target_vars.find (*tt, *tn, var));
+            lookup_type l (s->target_vars.find (*tt, *tn, var, &pat));
 
             if (l.defined ())
             {
               if (l->extra != 0) // Prepend/append?
+              {
                 pre_app (l, s, tt, tn, gt, gn);
+                memo = false;
+              }
 
-              return make_pair (move (l), d);
+              return memoize (make_pair (move (l), d));
             }
           }
         }
@@ -132,14 +169,17 @@ namespace build2
         {
           if (f && gt != nullptr)
           {
-            lookup_type l (s->target_vars.find (*gt, *gn, var));
+            lookup_type l (s->target_vars.find (*gt, *gn, var, &pat));
 
             if (l.defined ())
             {
               if (l->extra != 0) // Prepend/append?
+              {
                 pre_app (l, s, gt, gn, nullptr, nullptr);
+                memo = false;
+              }
 
-              return make_pair (move (l), d);
+              return memoize (make_pair (move (l), d));
             }
           }
         }
@@ -152,7 +192,8 @@ namespace build2
       {
         auto p (s->vars.lookup (var));
         if (p.first != nullptr)
-          return make_pair (lookup_type (*p.first, p.second, s->vars), d);
+          return memoize (
+            make_pair (lookup_type (*p.first, p.second, s->vars), d));
       }
 
       switch (var.visibility)
@@ -172,7 +213,7 @@ namespace build2
       }
     }
 
-    return make_pair (lookup_type (), size_t (~0));
+    return memoize (make_pair (lookup_type (), size_t (~0)));
   }
 
   auto scope::
@@ -980,6 +1021,11 @@ namespace build2
       s.root_ = &s;
     }
 
+    // Invalidate the lookup memos since we may have changed the outer scope
+    // chains (see variable_lookup_memo for details).
+    //
+    ctx.global_vars_version.fetch_add (1, memory_order_release);
+
     return er.first;
   }
 
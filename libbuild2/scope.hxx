@@ -118,6 +118,13 @@ namespace build2
       return var != nullptr ? operator[] (*var) : lookup_type ();
     }
 
+    lookup_type
+    operator[] (const builtin_variable& bv) const
+    {
+      const variable* var (ctx.find_variable (bv));
+      return var != nullptr ? operator[] (*var) : lookup_type ();
+    }
+
     // As above, but include target type/pattern-specific variables.
     //
     lookup_type
@@ -255,6 +262,10 @@ namespace build2
     //
     variable_type_map target_vars;
 
+    // Memoized outcomes of lookup_original() starting from this scope.
+    //
+    mutable variable_lookup_memo lookup_memo;
+
     // Set of buildfiles already loaded for this scope. The included
     // buildfiles are checked against the project's root scope while
     // imported -- against the global scope (global_scope).
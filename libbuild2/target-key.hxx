@@ -38,13 +38,17 @@ namespace build2
     as_name () const;
   };
 
+  // Note that the directories and names of targets are interned so when
+  // comparing keys of two targets we normally get away with comparing
+  // pointers.
+  //
   inline bool
   operator== (const target_key& x, const target_key& y)
   {
-    if (x.type  != y.type ||
-        *x.dir  != *y.dir ||
-        *x.out  != *y.out ||
-        *x.name != *y.name)
+    if (x.type != y.type                        ||
+        (x.dir  != y.dir  && *x.dir  != *y.dir)  ||
+        (x.out  != y.out  && *x.out  != *y.out)  ||
+        (x.name != y.name && *x.name != *y.name))
       return false;
 
     // Unless fixed, unspecified and specified extensions are assumed equal.
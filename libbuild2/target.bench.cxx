@@ -0,0 +1,188 @@
+// file      : libbuild2/target.bench.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <chrono>
+
+#include <cassert>
+#include <iostream>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/target.hxx>
+#include <libbuild2/context.hxx>
+#include <libbuild2/scheduler.hxx>
+#include <libbuild2/diagnostics.hxx>
+
+using namespace std;
+
+namespace build2
+{
+  // Usage: argv[0] [-n <targets>] [-p <prerequisites>] [-d <directories>]
+  //                [-r <rounds>]
+  //
+  // -n  number of targets, 300000 by default
+  // -p  number of prerequisites of each non-leaf target, 8 by default
+  // -d  number of directories the targets are spread over, 1000 by default
+  // -r  number of traversal rounds, 10 by default
+  //
+  // Enter a tree of file{} targets and measure the traversal that a no-op
+  // update performs during execute: for each prerequisite target check that
+  // it has been executed, examine its state, and descend into its own
+  // prerequisite targets. That is, this measures how well the per-target
+  // execution state (task count, state, prerequisite_targets) fits into the
+  // cache rather than the recipes themselves (see target::rule_vars_).
+  //
+  // Note that the targets are entered in the breadth-first order while
+  // traversed in the depth-first order, similar to how the targets are
+  // entered during load/match and then executed.
+  //
+  static inline uint64_t
+  now ()
+  {
+    using namespace chrono;
+
+    return static_cast<uint64_t> (
+      duration_cast<nanoseconds> (
+        steady_clock::now ().time_since_epoch ()).count ());
+  }
+
+  static const size_t executed (target::offset_executed);
+
+  // Return the number of targets visited and count those whose state is not
+  // as expected in mismatches. Note that the checks must not be compiled
+  // out (no assert()) since otherwise with NDEBUG the state reads can be
+  // optimized away.
+  //
+  static size_t
+  traverse (action a, const target& t, size_t& mismatches)
+  {
+    size_t r (1);
+
+    for (const prerequisite_target& p: t.prerequisite_targets[a])
+    {
+      const target& pt (*p.target);
+      const target::opstate& s (pt[a]);
+
+      if (s.task_count.load (memory_order_acquire) != executed ||
+          s.state != target_state::unchanged)
+        ++mismatches;
+
+      r += traverse (a, pt, mismatches);
+    }
+
+    return r;
+  }
+
+  int
+  main (int argc, char* argv[])
+  {
+    tracer trace ("main");
+
+    size_t n (300000);
+    size_t np (8);
+    size_t nd (1000);
+    size_t rounds (10);
+
+    for (int i (1); i != argc; ++i)
+    {
+      string a (argv[i]);
+
+      if (a == "-n")
+        n = stoul (argv[++i]);
+      else if (a == "-p")
+        np = stoul (argv[++i]);
+      else if (a == "-d")
+        nd = stoul (argv[++i]);
+      else if (a == "-r")
+        rounds = stoul (argv[++i]);
+      else
+        assert (false);
+    }
+
+    assert (n != 0 && np != 0 && nd != 0);
+
+    // Fake build system driver, default verbosity.
+    //
+    init_diag (1);
+    init (nullptr, argv[0]);
+
+    // Serial execution.
+    //
+    scheduler sched (1);
+    global_mutexes mutexes (1);
+    context ctx (sched, mutexes);
+
+    action a (perform_id, update_id);
+
+    uint64_t start (now ());
+
+    vector<const file*> ts;
+    ts.reserve (n);
+
+    for (size_t i (0); i != n; ++i)
+    {
+      dir_path d (dir_path ("/tmp/bench") /= "d" + to_string (i % nd));
+
+      ts.push_back (
+        &ctx.targets.insert<file> (move (d),
+                                   dir_path (),
+                                   "t" + to_string (i),
+                                   string ("o"),
+                                   trace));
+    }
+
+    // Target i has targets i * np + 1 through i * np + np as prerequisites.
+    //
+    for (size_t i (0); i != n; ++i)
+    {
+      const file& t (*ts[i]);
+
+      for (size_t j (i * np + 1); j <= i * np + np && j < n; ++j)
+        t.prerequisite_targets[a].push_back (ts[j]);
+
+      target::opstate& s (const_cast<file&> (t)[a]);
+      s.task_count.store (executed, memory_order_relaxed);
+      s.state = target_state::unchanged;
+    }
+
+    uint64_t entered (now ());
+
+    uint64_t best (0);
+    size_t visited (0), mismatches (0);
+    for (size_t r (0); r != rounds; ++r)
+    {
+      uint64_t s (now ());
+      visited += traverse (a, *ts[0], mismatches);
+      uint64_t e (now ());
+
+      if (r == 0 || e - s < best)
+        best = e - s;
+    }
+
+    if (visited != n * rounds || mismatches != 0)
+    {
+      cerr << "error: visited " << visited << " targets instead of "
+           << n * rounds << ", " << mismatches << " in unexpected state"
+           << endl;
+      return 1;
+    }
+
+    cout << "targets                " << n                          << endl
+         << "enter_ms               " << (entered - start) / 1000000 << endl
+         << "traverse_best_us       " << best / 1000                << endl
+         << "traverse_ns_per_target " << best / n                   << endl
+         << "sizeof_target          " << sizeof (target)            << endl
+         << "sizeof_file            " << sizeof (file)              << endl
+         << "sizeof_opstate         " << sizeof (target::opstate)   << endl
+         << "target_arena_bytes     " << ctx.target_arena.allocated () << endl;
+
+    return 0;
+  }
+}
+
+int
+main (int argc, char* argv[])
+{
+  return build2::main (argc, argv);
+}
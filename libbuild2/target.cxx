@@ -95,7 +95,7 @@ namespace build2
   const string& target::
   ext (string v)
   {
-    ulock l (ctx.targets.mutex_);
+    ulock l (*ext_mutex_);
 
     // Once the extension is set, it is immutable. However, it is possible
     // that someone has already "branded" this target with a different
@@ -225,6 +225,8 @@ namespace build2
 
     ++r.second;
     {
+      const variable_map& vars (this->vars ());
+
       auto p (vars.lookup (var));
       if (p.first != nullptr)
         r.first = lookup_type (*p.first, p.second, vars);
@@ -351,10 +353,12 @@ namespace build2
   const target* target_set::
   find (const target_key& k, tracer& trace) const
   {
-    slock sl (mutex_);
-    map_type::const_iterator i (map_.find (k));
+    const shard& s (shard_for (k));
+
+    slock sl (s.mutex);
+    map_type::const_iterator i (s.map.find (k));
 
-    if (i == map_.end ())
+    if (i == s.map.end ())
       return nullptr;
 
     const target& t (*i->second);
@@ -372,7 +376,7 @@ namespace build2
         // key could be inserted. In this case we simply re-run find ().
         //
         sl.unlock ();
-        ul = ulock (mutex_);
+        ul = ulock (s.mutex);
 
         if (ext) // Someone set the extension.
         {
@@ -423,6 +427,10 @@ namespace build2
       //
       assert (ctx.phase != run_phase::execute);
 
+      // Note: before the key components are moved to the target.
+      //
+      shard& s (shard_for (tk));
+
       optional<string> e (
         tt.fixed_extension != nullptr
         ? string (tt.fixed_extension (tk, nullptr /* root scope */))
@@ -435,16 +443,17 @@ namespace build2
       // case we proceed pretty much like find() except already under the
       // exclusive lock.
       //
-      ulock ul (mutex_);
+      ulock ul (s.mutex);
 
-      auto p (map_.emplace (target_key {&tt, &t->dir, &t->out, &t->name, e},
-                            unique_ptr<target> (t)));
+      auto p (s.map.emplace (target_key {&tt, &t->dir, &t->out, &t->name, e},
+                             unique_ptr<target> (t)));
 
       map_type::iterator i (p.first);
 
       if (p.second)
       {
         t->ext_ = &i->first.ext;
+        t->ext_mutex_ = &s.mutex;
         t->implied = implied;
         t->state.inner.target_ = t;
         t->state.outer.target_ = t;
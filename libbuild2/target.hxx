@@ -8,8 +8,6 @@
 #include <type_traits>  // aligned_storage
 #include <unordered_map>
 
-#include <libbutl/multi-index.mxx> // map_iterator_adapter
-
 #include <libbuild2/types.hxx>
 #include <libbuild2/forward.hxx>
 #include <libbuild2/utility.hxx>
@@ -112,10 +110,16 @@ namespace build2
     // when src == out). We also treat out of project targets as being in the
     // out tree.
     //
-    const dir_path    dir;  // Absolute and normalized.
-    const dir_path    out;  // Empty or absolute and normalized.
-    const string      name;
+    // The directories and name are interned in the context (see
+    // context::target_dirs) which means they are shared by all the targets
+    // in the same directory and equal keys of two targets normally compare
+    // by address (see target_key).
+    //
+    const dir_path&   dir;  // Absolute and normalized.
+    const dir_path&   out;  // Empty or absolute and normalized.
+    const string&     name;
     optional<string>* ext_; // Reference to value in target_key.
+    shared_mutex* ext_mutex_; // Mutex of target_set shard guarding ext_.
 
     const string* ext () const; // Return NULL if not specified.
     const string& ext (string);
@@ -347,6 +351,19 @@ namespace build2
   public:
     variable_map vars;
 
+    // Rule-specific variables of the inner and outer operation states (see
+    // opstate::vars()).
+    //
+    // The operation state (together with prerequisite_targets) is what the
+    // match and especially execute traversals touch for every target so we
+    // keep it compact by storing rarely accessed parts, such as these maps,
+    // here with the other cold members. This results in fewer cache lines
+    // per target, for example, in a no-op update (see target.bench.cxx).
+    //
+  private:
+    action_state<variable_map> rule_vars_;
+
+  public:
     // Lookup, including in groups to which this target belongs and then in
     // outer scopes (including target type/pattern-specific variables). If you
     // only want to lookup in this target, do it on the variable map directly
@@ -374,6 +391,13 @@ namespace build2
       return var != nullptr ? operator[] (*var) : lookup_type ();
     }
 
+    lookup_type
+    operator[] (const builtin_variable& bv) const
+    {
+      const variable* var (ctx.find_variable (bv));
+      return var != nullptr ? operator[] (*var) : lookup_type ();
+    }
+
     // As above but also return the depth at which the value is found. The
     // depth is calculated by adding 1 for each test performed. So a value
     // that is from the target will have depth 1. That from the group -- 2.
@@ -469,6 +493,21 @@ namespace build2
       //
       target_state state;
 
+      // Execution timing (see <libbuild2/durations.hxx> for background).
+      //
+      // The priority is the expected critical path of this target (that is,
+      // the longest chain of its prerequisites, including itself) based on
+      // the durations recorded during previous builds. It is calculated once
+      // the target has been matched and is used to decide the order in which
+      // the prerequisites are executed.
+      //
+      // The finish time (steady clock, in nanoseconds) is set when the
+      // recipe is executed and is used to calculate the durations of the
+      // targets that depend on this one (see execute_impl()).
+      //
+      atomic<uint64_t> priority {0};
+      uint64_t finished = 0;
+
       // Rule-specific variables.
       //
       // The rule (for this action) has to be matched before these variables
@@ -479,7 +518,11 @@ namespace build2
       // similar to the data pad. In other words, rule-specific variables are
       // only valid for this match-execute phase.
       //
-      variable_map vars;
+      // Note that the map itself is stored in the target, away from the rest
+      // of the operation state (see target::rule_vars_ for details).
+      //
+      variable_map&       vars ();
+      const variable_map& vars () const;
 
       // Lookup, continuing in the target-specific variables, etc. Note that
       // the group's rule-specific variables are not included. If you only
@@ -508,6 +551,13 @@ namespace build2
         return var != nullptr ? operator[] (*var) : lookup_type ();
       }
 
+      lookup_type
+      operator[] (const builtin_variable& bv) const
+      {
+        const variable* var (target_->ctx.find_variable (bv));
+        return var != nullptr ? operator[] (*var) : lookup_type ();
+      }
+
       // As above but also return the depth at which the value is found. The
       // depth is calculated by adding 1 for each test performed. So a value
       // that is from the rule will have depth 1. That from the target - 2,
@@ -531,14 +581,13 @@ namespace build2
       // Return a value suitable for assignment. See target for details.
       //
       value&
-      assign (const variable& var) {return vars.assign (var);}
+      assign (const variable& var) {return vars ().assign (var);}
 
       value&
-      assign (const variable* var) {return vars.assign (var);} // For cached.
-
-    public:
-      explicit
-      opstate (context& c): vars (c, false /* global */) {}
+      assign (const variable* var) // For cached.
+      {
+        return vars ().assign (var);
+      }
 
     private:
       friend class target_set;
@@ -752,9 +801,11 @@ namespace build2
   public:
     target (context& c, dir_path d, dir_path o, string n)
         : ctx (c),
-          dir (move (d)), out (move (o)), name (move (n)),
+          dir (c.target_dirs.insert (move (d))),
+          out (c.target_dirs.insert (move (o))),
+          name (c.target_names.insert (move (n))),
           vars (c, false /* global */),
-          state (c) {}
+          rule_vars_ (c, false /* global */) {}
 
     target (target&&) = delete;
     target& operator= (target&&) = delete;
@@ -765,6 +816,20 @@ namespace build2
     virtual
     ~target ();
 
+    // Targets are allocated in the context's arena and the memory is only
+    // released in bulk when the context is destroyed. Note that the
+    // non-placement operator new is hidden on purpose: there is no other
+    // way to create a target.
+    //
+    static void*
+    operator new (size_t n, context& c) {return c.target_arena.allocate (n);}
+
+    static void
+    operator delete (void*, context&) noexcept {} // Constructor failure.
+
+    static void
+    operator delete (void*) noexcept {}
+
     friend class target_set;
   };
 
@@ -1292,9 +1357,12 @@ namespace build2
           const dir_path& out,
           const string& name) const
     {
-      slock l (mutex_);
-      auto i (map_.find (target_key {&type, &dir, &out, &name, nullopt}));
-      return i != map_.end () ? i->second.get () : nullptr;
+      target_key k {&type, &dir, &out, &name, nullopt};
+      const shard& s (shard_for (k));
+
+      slock l (s.mutex);
+      auto i (s.map.find (k));
+      return i != s.map.end () ? i->second.get () : nullptr;
     }
 
     template <typename T>
@@ -1306,7 +1374,8 @@ namespace build2
 
     // If the target was inserted, keep the map exclusive-locked and return
     // the lock. In this case, the target is effectively still being created
-    // since nobody can see it until the lock is released.
+    // since nobody can see it until the lock is released. Note that only the
+    // shard containing the target is locked (see below).
     //
     pair<target&, ulock>
     insert_locked (const target_type&,
@@ -1381,16 +1450,15 @@ namespace build2
     // Note: not MT-safe so can only be used during serial execution.
     //
   public:
-    using iterator = butl::map_iterator_adapter<map_type::const_iterator>;
+    class iterator;
 
-    iterator begin () const {return map_.begin ();}
-    iterator end ()   const {return map_.end ();}
+    iterator begin () const;
+    iterator end ()   const;
 
     void
-    clear () {map_.clear ();}
+    clear ();
 
   private:
-    friend class target; // Access to mutex.
     friend class context;
 
     explicit
@@ -1398,10 +1466,119 @@ namespace build2
 
     context& ctx;
 
-    mutable shared_mutex mutex_;
-    map_type map_;
+    // The set is split into shards by the key hash (which ignores the
+    // extension, see target_key) with each shard protected by its own mutex
+    // so that concurrent inserts and finds (for example, by search() during
+    // match) rarely contend with each other. Because the extension is not
+    // part of the hash, updating it (see find()) stays within the shard.
+    //
+    struct shard
+    {
+      mutable shared_mutex mutex;
+      map_type map;
+    };
+
+    static const size_t shard_count = 64;
+
+    shard&
+    shard_for (const target_key& k)
+    {
+      return shards_[std::hash<target_key> () (k) % shard_count];
+    }
+
+    const shard&
+    shard_for (const target_key& k) const
+    {
+      return shards_[std::hash<target_key> () (k) % shard_count];
+    }
+
+    shard shards_[shard_count];
+
+  public:
+    // Iterate over the targets in all the shards.
+    //
+    class iterator
+    {
+    public:
+      using value_type        = map_type::mapped_type;
+      using pointer           = const value_type*;
+      using reference         = const value_type&;
+      using difference_type   = std::ptrdiff_t;
+      using iterator_category = std::forward_iterator_tag;
+
+      iterator () = default;
+
+      reference operator* () const {return i_->second;}
+      pointer  operator-> () const {return &i_->second;}
+
+      iterator&
+      operator++ () {++i_; skip (); return *this;}
+
+      iterator
+      operator++ (int) {iterator r (*this); operator++ (); return r;}
+
+      friend bool
+      operator== (const iterator& x, const iterator& y)
+      {
+        return x.s_ == y.s_ && (x.s_ == x.e_ || x.i_ == y.i_);
+      }
+
+      friend bool
+      operator!= (const iterator& x, const iterator& y) {return !(x == y);}
+
+    private:
+      friend class target_set;
+
+      iterator (const shard* s, const shard* e)
+          : s_ (s), e_ (e)
+      {
+        if (s_ != e_)
+        {
+          i_ = s_->map.begin ();
+          skip ();
+        }
+      }
+
+      // Advance to the next non-empty shard if we are at the end of the
+      // current one.
+      //
+      void
+      skip ()
+      {
+        while (i_ == s_->map.end ())
+        {
+          if (++s_ == e_)
+            break;
+
+          i_ = s_->map.begin ();
+        }
+      }
+
+      const shard* s_ = nullptr;
+      const shard* e_ = nullptr;
+      map_type::const_iterator i_;
+    };
   };
 
+  inline target_set::iterator target_set::
+  begin () const
+  {
+    return iterator (shards_, shards_ + shard_count);
+  }
+
+  inline target_set::iterator target_set::
+  end () const
+  {
+    return iterator (shards_ + shard_count, shards_ + shard_count);
+  }
+
+  inline void target_set::
+  clear ()
+  {
+    for (shard& s: shards_)
+      s.map.clear ();
+  }
+
   // Modification time-based target.
   //
   class LIBBUILD2_SYMEXPORT mtime_target: public target
@@ -1805,7 +1982,7 @@ namespace build2
   target_factory (context& c,
                   const target_type&, dir_path d, dir_path o, string n)
   {
-    return new T (c, move (d), move (o), move (n));
+    return new (c) T (c, move (d), move (o), move (n));
   }
 
   // Return fixed target extension unless one was specified.
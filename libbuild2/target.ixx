@@ -14,7 +14,7 @@ namespace build2
   inline const string* target::
   ext () const
   {
-    slock l (ctx.targets.mutex_);
+    slock l (*ext_mutex_);
     return *ext_ ? &**ext_ : nullptr;
   }
 
@@ -202,6 +202,22 @@ namespace build2
     return os << t.key ();
   }
 
+  // target::opstate
+  //
+  inline variable_map& target::opstate::
+  vars ()
+  {
+    target& t (const_cast<target&> (*target_));
+    return this == &t.state.inner ? t.rule_vars_.inner : t.rule_vars_.outer;
+  }
+
+  inline const variable_map& target::opstate::
+  vars () const
+  {
+    const target& t (*target_);
+    return this == &t.state.inner ? t.rule_vars_.inner : t.rule_vars_.outer;
+  }
+
   // mark()/unmark()
   //
 
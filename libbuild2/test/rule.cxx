@@ -644,6 +644,7 @@ namespace build2
 
       try
       {
+        process_span ps (args);
         process p (prev == nullptr
                    ? process (args, 0, out)       // First process.
                    : process (args, *prev, out)); // Next process.
@@ -138,7 +138,8 @@ namespace build2
         }
 
         assert (ps == '\0');
-        state_.push (state {m, a, ps, s, n, q, *esc, s1, s2});
+        state_.push (state {m, a, ps, s, n, q, *esc, s1, s2,
+                            special_chars (s1, ps, q)});
       }
 
       token lexer::
@@ -1878,6 +1878,7 @@ namespace build2
             if (verb >= 2)
               print_process (args);
 
+            process_span ps (args);
             process pr (
               pp,
               args.data (),
@@ -0,0 +1,157 @@
+// file      : libbuild2/timeline.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <libbuild2/timeline.hxx>
+
+#include <chrono>
+#include <cstdio> // snprintf()
+
+using namespace std;
+using namespace butl;
+
+namespace build2
+{
+  timeline* build_timeline = nullptr;
+
+  // TLS cache of the thread's event buffer. Note that we also store the
+  // timeline it belongs to in case it gets replaced.
+  //
+  static
+#ifdef __cpp_thread_local
+  thread_local
+#else
+  __thread
+#endif
+  const void* timeline_owner = nullptr;
+
+  static
+#ifdef __cpp_thread_local
+  thread_local
+#else
+  __thread
+#endif
+  void* timeline_buffer = nullptr;
+
+  uint64_t timeline::
+  now () noexcept
+  {
+    using namespace chrono;
+
+    return static_cast<uint64_t> (
+      duration_cast<nanoseconds> (
+        steady_clock::now ().time_since_epoch ()).count ());
+  }
+
+  timeline::
+  timeline (path f)
+      : file_ (move (f)), epoch_ (now ())
+  {
+  }
+
+  timeline::
+  ~timeline ()
+  {
+    if (build_timeline == this)
+      build_timeline = nullptr;
+  }
+
+  timeline::buffer& timeline::
+  local ()
+  {
+    if (timeline_owner != this)
+    {
+      mlock l (mutex_);
+
+      buffers_.push_back (unique_ptr<buffer> (new buffer));
+
+      buffer& b (*buffers_.back ());
+      b.tid = buffers_.size ();
+      b.events.reserve (1024);
+
+      timeline_owner = this;
+      timeline_buffer = &b;
+    }
+
+    return *static_cast<buffer*> (timeline_buffer);
+  }
+
+  void timeline::
+  complete (const char* c, string n, uint64_t s, uint64_t e, arguments a)
+  {
+    local ().events.push_back (
+      event {'X', c, move (n), s, e > s ? e - s : 0, move (a)});
+  }
+
+  void timeline::
+  instant (const char* c, string n, uint64_t t, arguments a)
+  {
+    local ().events.push_back (event {'i', c, move (n), t, 0, move (a)});
+  }
+
+  // Write nanoseconds as microseconds (the trace event format unit).
+  //
+  static void
+  write_time (ofdstream& os, uint64_t ns)
+  {
+    char b[32];
+    snprintf (b, sizeof (b), "%llu.%03u",
+              static_cast<unsigned long long> (ns / 1000),
+              static_cast<unsigned> (ns % 1000));
+    os << b;
+  }
+
+  void timeline::
+  write () const
+  {
+    ofdstream os (file_);
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << '\n'
+       << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+       << "\"args\":{\"name\":\"build2\"}}";
+
+    for (const unique_ptr<buffer>& b: buffers_)
+    {
+      for (const event& e: b->events)
+      {
+        os << ",\n{\"name\":";
+        write_json_string (os, e.name);
+        os << ",\"cat\":";
+        write_json_string (os, e.category);
+        os << ",\"ph\":\"" << e.phase << '"'
+           << ",\"pid\":1,\"tid\":" << b->tid
+           << ",\"ts\":";
+        write_time (os, e.start > epoch_ ? e.start - epoch_ : 0);
+
+        if (e.phase == 'X')
+        {
+          os << ",\"dur\":";
+          write_time (os, e.duration);
+        }
+        else
+          os << ",\"s\":\"t\"";
+
+        if (!e.args.empty ())
+        {
+          os << ",\"args\":{";
+
+          for (auto i (e.args.begin ()); i != e.args.end (); ++i)
+          {
+            if (i != e.args.begin ())
+              os << ',';
+
+            write_json_string (os, i->first);
+            os << ':';
+            write_json_string (os, i->second);
+          }
+
+          os << '}';
+        }
+
+        os << '}';
+      }
+    }
+
+    os << "\n]}" << '\n';
+    os.close ();
+  }
+}
@@ -0,0 +1,98 @@
+// file      : libbuild2/timeline.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef LIBBUILD2_TIMELINE_HXX
+#define LIBBUILD2_TIMELINE_HXX
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/export.hxx>
+
+namespace build2
+{
+  // Build timeline in the Chrome trace event format (see --trace-file). The
+  // resulting file can be viewed with chrome://tracing or Perfetto.
+  //
+  // Events are recorded into per-thread buffers that are only ever appended
+  // to by the owning thread so recording an event does not require any
+  // synchronization (other than when a thread records its first event). The
+  // buffers are written out once the build is complete, after all the
+  // threads that could be recording events are done.
+  //
+  // All the timestamps are in nanoseconds since an arbitrary epoch (see
+  // now()).
+  //
+  class LIBBUILD2_SYMEXPORT timeline
+  {
+  public:
+    using arguments = small_vector<pair<const char*, string>, 2>;
+
+    // Record a complete event (a span). The category and argument names
+    // should be string literals.
+    //
+    void
+    complete (const char* category,
+              string name,
+              uint64_t start, uint64_t end,
+              arguments = {});
+
+    // Record an instant event.
+    //
+    void
+    instant (const char* category, string name, uint64_t time,
+             arguments = {});
+
+    // Write the timeline to the file. Should be called serially once all
+    // the threads are done recording. Throw io_error on failure.
+    //
+    void
+    write () const;
+
+    const path&
+    file () const {return file_;}
+
+    static uint64_t
+    now () noexcept;
+
+    explicit
+    timeline (path);
+
+    ~timeline ();
+
+    timeline (const timeline&) = delete;
+    timeline& operator= (const timeline&) = delete;
+
+  private:
+    struct event
+    {
+      char phase; // 'X' or 'i'.
+      const char* category;
+      string name;
+      uint64_t start;
+      uint64_t duration;
+      arguments args;
+    };
+
+    struct buffer
+    {
+      size_t tid;
+      vector<event> events;
+    };
+
+    buffer&
+    local ();
+
+    path file_;
+    uint64_t epoch_;
+
+    mutex mutex_;
+    vector<unique_ptr<buffer>> buffers_;
+  };
+
+  // The timeline of this build or NULL if not enabled.
+  //
+  LIBBUILD2_SYMEXPORT extern timeline* build_timeline;
+}
+
+#endif // LIBBUILD2_TIMELINE_HXX
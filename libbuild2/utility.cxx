@@ -6,12 +6,14 @@
 #include <time.h>   // tzset() (POSIX), _tzset() (Windows)
 
 #include <cerrno>   // ENOENT
+#include <cstdio>   // snprintf()
 #include <cstring>  // strlen(), str[n]cmp()
 #include <iostream> // cerr
 
 #include <libbuild2/target.hxx>
 #include <libbuild2/context.hxx>
 #include <libbuild2/variable.hxx>
+#include <libbuild2/timeline.hxx>
 #include <libbuild2/diagnostics.hxx>
 
 using namespace std;
@@ -250,6 +252,69 @@ namespace build2
       fail (l) << "unable to execute " << args[0] << ": " << e << endf;
   }
 
+  process_span::
+  process_span (const char* const* args)
+      : args_ (args),
+        cargs_ (nullptr),
+        start_ (build_timeline != nullptr ? timeline::now () : 0)
+  {
+  }
+
+  process_span::
+  process_span (const cstrings& args)
+      : args_ (nullptr),
+        cargs_ (&args),
+        start_ (build_timeline != nullptr ? timeline::now () : 0)
+  {
+  }
+
+  process_span::
+  ~process_span ()
+  {
+    try
+    {
+      complete ();
+    }
+    catch (...) {} // Ignore (most likely out of memory).
+  }
+
+  void process_span::
+  complete ()
+  {
+    if (start_ == 0)
+      return;
+
+    uint64_t s (start_), e (timeline::now ());
+    start_ = 0;
+
+    // Skip if the process was never started.
+    //
+    if (cargs_ != nullptr ? cargs_->empty () : args_ == nullptr)
+      return;
+
+    const char* const* args (cargs_ != nullptr ? cargs_->data () : args_);
+
+    // Use the program name without the directory as the span name.
+    //
+    const char* n (args[0]);
+    for (const char* p (n); *p != '\0'; ++p)
+    {
+      if (path::traits_type::is_separator (*p))
+        n = p + 1;
+    }
+
+    string c;
+    for (const char* const* a (args); *a != nullptr; ++a)
+    {
+      if (a != args)
+        c += ' ';
+
+      c += *a;
+    }
+
+    build_timeline->complete ("process", n, s, e, {{"command", move (c)}});
+  }
+
   bool
   run_wait (const char* args[], process& pr, const location& loc)
   try
@@ -553,6 +618,38 @@ namespace build2
     return r;
   }
 
+  void
+  write_json_string (ostream& os, const char* s)
+  {
+    os << '"';
+
+    for (; *s != '\0'; ++s)
+    {
+      char c (*s);
+
+      switch (c)
+      {
+      case '"':  os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n";  break;
+      case '\t': os << "\\t";  break;
+      default:
+        {
+          if (static_cast<unsigned char> (c) < 0x20)
+          {
+            char b[7];
+            snprintf (b, sizeof (b), "\\u%04x", static_cast<unsigned> (c));
+            os << b;
+          }
+          else
+            os << c;
+        }
+      }
+    }
+
+    os << '"';
+  }
+
   void
   init (void (*t) (bool),
         const char* a0,
@@ -241,6 +241,44 @@ namespace build2
   [[noreturn]] LIBBUILD2_SYMEXPORT void
   run_search_fail (const path&, const location& = location ());
 
+  // Record a process span in the build timeline (see --trace-file), if
+  // enabled. The span starts when this object is constructed and completes
+  // when it is destroyed (or complete() is called) so it should be declared
+  // just before the process is started (and after its arguments are final)
+  // in the scope that also waits for the process. For example:
+  //
+  // process_span ps (args);
+  // process pr (run_start (...));
+  // ...
+  // run_finish (args, pr);
+  //
+  // Note that the arguments are only examined when the span is completed
+  // and so must still be valid at that point. In particular, the cstrings
+  // version may be constructed before the arguments are filled in.
+  //
+  class LIBBUILD2_SYMEXPORT process_span
+  {
+  public:
+    explicit
+    process_span (const char* const* args);
+
+    explicit
+    process_span (const cstrings& args);
+
+    ~process_span ();
+
+    void
+    complete ();
+
+    process_span (const process_span&) = delete;
+    process_span& operator= (const process_span&) = delete;
+
+  private:
+    const char* const* args_;
+    const cstrings* cargs_;
+    uint64_t start_;
+  };
+
   // Wait for process termination returning true if the process exited
   // normally with a zero code and false otherwise. The latter case is
   // normally followed up with a call to run_finish().
@@ -335,6 +373,7 @@ namespace build2
        const dir_path& cwd = dir_path (),
        const char* const* env = nullptr)
   {
+    process_span ps (args);
     process pr (run_start (process_env (p, env), args, 0, 1, true, cwd));
     run_finish (args, pr);
   }
@@ -387,6 +426,7 @@ namespace build2
        const dir_path& cwd = dir_path (),
        const char* const* env = nullptr)
   {
+    process_span ps (args);
     process pr (run_start (verbosity, args, 0, 1, true, cwd, env));
     run_finish (args, pr);
   }
@@ -772,6 +812,17 @@ namespace build2
   {
     return apply_pattern (s, p.c_str ());
   }
+
+  // Write the string as a JSON string literal (quoted and escaped).
+  //
+  LIBBUILD2_SYMEXPORT void
+  write_json_string (ostream&, const char*);
+
+  inline void
+  write_json_string (ostream& os, const string& s)
+  {
+    write_json_string (os, s.c_str ());
+  }
 }
 
 #include <libbuild2/utility.ixx>
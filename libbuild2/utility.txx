@@ -68,6 +68,7 @@ namespace build2
        bool ignore_exit,
        sha256* checksum)
   {
+    process_span ps (args);
     process pr (run_start (verbosity,
                            pe,
                            args,
@@ -1428,6 +1428,31 @@ namespace build2
     }
   }
 
+  // builtin_variable
+  //
+  // Note: function-local to sidestep the static initialization order issues
+  // since builtin variables are declared at namespace scope.
+  //
+  static atomic_count&
+  builtin_variable_count ()
+  {
+    static atomic_count r (0);
+    return r;
+  }
+
+  builtin_variable::
+  builtin_variable (const char* n)
+      : name (n),
+        id (builtin_variable_count ().fetch_add (1, memory_order_relaxed))
+  {
+  }
+
+  size_t builtin_variable::
+  count ()
+  {
+    return builtin_variable_count ().load (memory_order_relaxed);
+  }
+
   // variable_map
   //
   const variable_map empty_variable_map (nullptr /* context */);
@@ -1444,13 +1469,22 @@ namespace build2
       //    This can happen if the values were entered before the variables
       //    were aliased. Possible but probably highly unlikely.
       //
-      auto i (m_.find (*v));
-      if (i != m_.end ())
+      if (value_type* p = small_find (*v))
       {
-        r = &i->second;
+        r = &p->second;
         break;
       }
 
+      if (large_ != nullptr)
+      {
+        auto i (large_->find (*v));
+        if (i != large_->end ())
+        {
+          r = &i->second;
+          break;
+        }
+      }
+
       v = v->aliases;
 
     } while (v != &var && v != nullptr);
@@ -1482,8 +1516,47 @@ namespace build2
   {
     assert (!global_ || ctx->phase == run_phase::load);
 
-    auto p (m_.emplace (var, value_data (typed ? var.type : nullptr)));
-    value_data& r (p.first->second);
+    pair<value_data*, bool> p (nullptr, false);
+
+    if (value_type* e = small_find (var))
+      p.first = &e->second;
+    else if (small_size_ != small_capacity)
+    {
+      // Allocate the segment on first use.
+      //
+      size_t i (small_size_);
+      size_t s (i == 0 ? 0 : 1);
+
+      if (i == 0 || i == 1)
+        small_[s] = static_cast<value_type*> (
+          ::operator new ((s + 1) * sizeof (value_type)));
+
+      value_type* n (new (&small_at (i)) value_type (
+                       var, value_data (typed ? var.type : nullptr)));
+
+      // Insert the index keeping the ascending order.
+      //
+      auto c (compare ());
+      size_t j (i);
+      for (; j != 0 && c (var, small_pos (j - 1).first); --j)
+        small_order_[j] = small_order_[j - 1];
+
+      small_order_[j] = static_cast<uint8_t> (i);
+      small_size_++;
+
+      p = make_pair (&n->second, true);
+    }
+    else
+    {
+      if (large_ == nullptr)
+        large_.reset (new map_type);
+
+      auto i (
+        large_->emplace (var, value_data (typed ? var.type : nullptr)));
+      p = make_pair (&i.first->second, i.second);
+    }
+
+    value_data& r (*p.first);
 
     if (!p.second)
     {
@@ -1497,15 +1570,218 @@ namespace build2
 
     r.version++;
 
+    // Invalidate the lookup memos (see variable_lookup_memo for details).
+    //
+    if (global_)
+      ctx->global_vars_version.fetch_add (1, memory_order_release);
+
     return make_pair (reference_wrapper<value> (r), p.second);
   }
 
+  auto variable_map::
+  lookup_namespace (const variable& ns) const ->
+    pair<const_iterator, const_iterator>
+  {
+    // The small entries in the namespace are contiguous in the ascending
+    // order, the same as in the tree (see prefix_map::find_sub()).
+    //
+    auto c (compare ());
+
+    size_t i (0);
+    for (; i != small_size_ && c (small_pos (i).first, ns); ++i) ;
+
+    size_t n (i);
+    for (; n != small_size_ && c.prefix (ns, small_pos (n).first); ++n) ;
+
+    map_type::const_iterator j, je;
+    if (large_ != nullptr)
+    {
+      auto r (large_->find_sub (ns));
+      j = r.first;
+      je = r.second;
+    }
+
+    return make_pair (const_iterator (base_iterator (*this, i, n, j, je),
+                                      *this),
+                      const_iterator (base_iterator (*this, n, n, je, je),
+                                      *this));
+  }
+
+  auto variable_map::
+  begin () const -> const_iterator
+  {
+    map_type::const_iterator j, je;
+    if (large_ != nullptr)
+    {
+      j = large_->begin ();
+      je = large_->end ();
+    }
+
+    return const_iterator (base_iterator (*this, 0, small_size_, j, je),
+                           *this);
+  }
+
+  auto variable_map::
+  end () const -> const_iterator
+  {
+    map_type::const_iterator je;
+    if (large_ != nullptr)
+      je = large_->end ();
+
+    return const_iterator (
+      base_iterator (*this, small_size_, small_size_, je, je), *this);
+  }
+
+  auto variable_map::
+  small_find (const variable& var) const -> value_type*
+  {
+    // Note that variables are pooled so we can compare them by address.
+    //
+    for (size_t i (0); i != small_size_; ++i)
+    {
+      value_type& e (small_at (i));
+      if (&e.first.get () == &var)
+        return &e;
+    }
+
+    return nullptr;
+  }
+
+  void variable_map::
+  small_copy (const variable_map& x)
+  {
+    assert (small_size_ == 0);
+
+    // If copying an entry throws, destroy the ones copied so far and free
+    // the segments leaving the small array empty.
+    //
+    try
+    {
+      for (size_t i (0); i != x.small_size_; ++i)
+      {
+        if (i == 0 || i == 1)
+          small_[i] = static_cast<value_type*> (
+            ::operator new ((i + 1) * sizeof (value_type)));
+
+        new (&small_at (i)) value_type (x.small_at (i));
+        small_size_++;
+      }
+    }
+    catch (...)
+    {
+      small_clear ();
+      throw;
+    }
+
+    copy (x.small_order_, x.small_order_ + x.small_size_, small_order_);
+  }
+
+  void variable_map::
+  small_clear ()
+  {
+    for (size_t i (0); i != small_size_; ++i)
+      small_at (i).~value_type ();
+
+    ::operator delete (small_[0]);
+    ::operator delete (small_[1]);
+
+    small_[0] = small_[1] = nullptr;
+    small_size_ = 0;
+  }
+
+  variable_map::
+  variable_map (variable_map&& x)
+      : ctx (x.ctx),
+        small_size_ (x.small_size_),
+        global_ (x.global_),
+        large_ (move (x.large_))
+  {
+    small_[0] = x.small_[0];
+    small_[1] = x.small_[1];
+    copy (x.small_order_, x.small_order_ + small_size_, small_order_);
+
+    x.small_[0] = x.small_[1] = nullptr;
+    x.small_size_ = 0;
+  }
+
+  variable_map::
+  variable_map (const variable_map& x)
+      : ctx (x.ctx),
+        global_ (x.global_),
+        large_ (x.large_ != nullptr ? new map_type (*x.large_) : nullptr)
+  {
+    // Note that if this throws, small_copy() cleans up after itself and
+    // large_, being a fully-constructed member, is destroyed automatically.
+    //
+    small_copy (x);
+  }
+
+  variable_map& variable_map::
+  operator= (variable_map&& x)
+  {
+    if (this != &x)
+    {
+      clear ();
+
+      ctx = x.ctx;
+      global_ = x.global_;
+
+      small_[0] = x.small_[0];
+      small_[1] = x.small_[1];
+      small_size_ = x.small_size_;
+      copy (x.small_order_, x.small_order_ + small_size_, small_order_);
+      large_ = move (x.large_);
+
+      x.small_[0] = x.small_[1] = nullptr;
+      x.small_size_ = 0;
+    }
+
+    return *this;
+  }
+
+  variable_map& variable_map::
+  operator= (const variable_map& x)
+  {
+    // Copy first so that we are left unchanged if this throws.
+    //
+    if (this != &x)
+      *this = variable_map (x);
+
+    return *this;
+  }
+
+  void variable_map::
+  clear ()
+  {
+    small_clear ();
+    large_.reset ();
+  }
+
+  size_t variable_map::
+  bytes () const
+  {
+    // Small entries take up their segments while in the tree we assume a
+    // node is the value plus three pointers and color.
+    //
+    size_t r (small_[0] != nullptr ? sizeof (value_type) : 0);
+
+    if (small_[1] != nullptr)
+      r += 2 * sizeof (value_type);
+
+    if (large_ != nullptr)
+      r += sizeof (map_type) +
+        large_->size () * (sizeof (value_type) + 4 * sizeof (void*));
+
+    return r;
+  }
+
   // variable_type_map
   //
   lookup variable_type_map::
   find (const target_type& type,
         const string& name,
-        const variable& var) const
+        const variable& var,
+        bool* pattern) const
   {
     // Search across target type hierarchy.
     //
@@ -1532,6 +1808,9 @@ namespace build2
         //
         if (pat != "*")
         {
+          if (pattern != nullptr)
+            *pattern = true;
+
           if (name.size () < pat.size () - 1 || // One for '*' or '?'.
               !butl::path_match (name, pat))
             continue;
@@ -1562,6 +1841,54 @@ namespace build2
     return lookup ();
   }
 
+  // variable_lookup_memo
+  //
+  auto variable_lookup_memo::
+  find (const key_type& k, size_t ver) const -> const result_type*
+  {
+    const entry_type* e (table_.find (k, hasher () (k)));
+
+    if (e == nullptr || e->version != ver)
+      return nullptr;
+
+    const result_type& r (e->result);
+
+    // Make sure the value has been typified (normally done on the first
+    // access, see variable_map::lookup()) in case the variable has been
+    // assigned a type after we have memoized it.
+    //
+    const variable& var (*std::get<0> (k));
+    if (r.first.defined () &&
+        var.type != nullptr &&
+        r.first->type.load (memory_order_acquire) != var.type)
+      return nullptr;
+
+    return &r;
+  }
+
+  void variable_lookup_memo::
+  insert (context& ctx, const key_type& k, size_t ver, const result_type& r)
+  {
+    shared_mutex& m (
+      ctx.mutexes.variable_cache[
+        std::hash<variable_lookup_memo*> () (this) %
+        ctx.mutexes.variable_cache_size]);
+
+    ulock l (m);
+
+    size_t h (hasher () (k));
+
+    // Someone else could have memoized it while we were looking up.
+    //
+    if (const entry_type* e = table_.find (k, h))
+    {
+      if (e->version == ver)
+        return;
+    }
+
+    table_.insert (h, k, r, ver);
+  }
+
   template struct LIBBUILD2_DEFEXPORT value_traits<strings>;
   template struct LIBBUILD2_DEFEXPORT value_traits<vector<name>>;
   template struct LIBBUILD2_DEFEXPORT value_traits<paths>;
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <set>
+#include <deque>
 #include <type_traits>   // aligned_storage
 #include <unordered_map>
 
@@ -1067,6 +1068,11 @@ namespace build2
     const variable*
     find (const string& name) const;
 
+    // Return the number of variables in the pool.
+    //
+    size_t
+    size () const {return map_.size ();}
+
     // Find existing or insert new variable.
     //
     // Unless specified explicitly, the variable is untyped, non-overridable,
@@ -1300,6 +1306,42 @@ namespace build2
 
     context* global_;
   };
+
+  // Builtin variable handle.
+  //
+  // A builtin variable is declared statically (normally at namespace scope
+  // in the rule implementation) and is assigned a stable numeric id on
+  // construction. This id is used to cache the corresponding pool variable
+  // in the context so that looking it up does not involve hashing its name
+  // (see context::find_variable()). For example:
+  //
+  // static const builtin_variable var_install ("install");
+  //
+  // if (auto l = t[var_install])
+  //   ...
+  //
+  // Note that this is purely an access mechanism: the variable should still
+  // be entered into the pool (with the appropriate type, visibility, etc) by
+  // the module that owns it. A lookup of a variable that hasn't (yet) been
+  // entered is undefined, the same as for the by-name lookup.
+  //
+  class LIBBUILD2_SYMEXPORT builtin_variable
+  {
+  public:
+    const char* const name;
+    const size_t id;
+
+    explicit
+    builtin_variable (const char* name);
+
+    builtin_variable (const builtin_variable&) = delete;
+    builtin_variable& operator= (const builtin_variable&) = delete;
+
+    // Return the number of builtin variables declared so far.
+    //
+    static size_t
+    count ();
+  };
 }
 
 // variable_map
@@ -1345,10 +1387,71 @@ namespace build2
     // Note that we guarantee ascending iteration order (e.g., for predictable
     // dump output in tests).
     //
+    // Most maps (target, prerequisite, rule-specific) contain only a handful
+    // of entries (if any) so the first small_capacity entries are stored in
+    // a small array that is searched linearly by comparing the variable
+    // pointers and only the rest end up in the (lazily-allocated) tree. The
+    // small entries are never moved once inserted since we hand out
+    // references to values (see also variable_type_map's cache). Instead,
+    // they are stored in two segments (of 1 and 2 entries; most maps with
+    // entries only have one) with a separate index that keeps them in the
+    // ascending order.
+    //
     using map_type = butl::prefix_map<reference_wrapper<const variable>,
                                       value_data,
                                       '.'>;
     using size_type = map_type::size_type;
+    using value_type = map_type::value_type;
+
+    static const size_t small_capacity = 3;
+
+    // Iterator over the small entries and the tree merged in the ascending
+    // order.
+    //
+    class base_iterator
+    {
+    public:
+      using value_type        = variable_map::value_type;
+      using reference         = const value_type&;
+      using pointer           = const value_type*;
+      using difference_type   = ptrdiff_t;
+      using iterator_category = std::forward_iterator_tag;
+
+      base_iterator () = default;
+
+      reference operator* () const;
+      pointer operator-> () const {return &operator* ();}
+
+      base_iterator& operator++ ();
+      base_iterator  operator++ (int) {auto r (*this); ++*this; return r;}
+
+      bool
+      operator== (const base_iterator& x) const
+      {
+        return i_ == x.i_ && j_ == x.j_;
+      }
+
+      bool
+      operator!= (const base_iterator& x) const {return !(*this == x);}
+
+    private:
+      friend class variable_map;
+
+      base_iterator (const variable_map& m,
+                     size_t i, size_t n,
+                     map_type::const_iterator j, map_type::const_iterator je)
+          : m_ (&m), i_ (i), n_ (n), j_ (j), je_ (je) {}
+
+      // True if the current entry is from the small array.
+      //
+      bool
+      small () const;
+
+      const variable_map* m_ = nullptr;
+      size_t i_ = 0;                    // Current small index position.
+      size_t n_ = 0;                    // End small index position.
+      map_type::const_iterator j_, je_; // Current/end tree position.
+    };
 
     template <typename I>
     class iterator_adapter: public I
@@ -1371,7 +1474,7 @@ namespace build2
       const variable_map* m_;
     };
 
-    using const_iterator = iterator_adapter<map_type::const_iterator>;
+    using const_iterator = iterator_adapter<base_iterator>;
 
     // Lookup. Note that variable overrides will not be applied, even if
     // set in this map.
@@ -1401,6 +1504,15 @@ namespace build2
       return var != nullptr ? operator[] (*var) : lookup_type ();
     }
 
+    lookup_type
+    operator[] (const builtin_variable& bv) const
+    {
+      const variable* var (ctx != nullptr
+                           ? ctx->find_variable (bv)
+                           : nullptr);
+      return var != nullptr ? operator[] (*var) : lookup_type ();
+    }
+
     // If typed is false, leave the value untyped even if the variable is.
     // The second half of the pair is the storage variable.
     //
@@ -1448,24 +1560,28 @@ namespace build2
     insert (const variable&, bool typed = true);
 
     pair<const_iterator, const_iterator>
-    lookup_namespace (const variable& ns) const
-    {
-      auto r (m_.find_sub (ns));
-      return make_pair (const_iterator (r.first,  *this),
-                        const_iterator (r.second, *this));
-    }
+    lookup_namespace (const variable& ns) const;
 
     const_iterator
-    begin () const {return const_iterator (m_.begin (), *this);}
+    begin () const;
 
     const_iterator
-    end () const {return const_iterator (m_.end (), *this);}
+    end () const;
 
     bool
-    empty () const {return m_.empty ();}
+    empty () const {return small_size_ == 0;}
 
     size_type
-    size () const {return m_.size ();}
+    size () const
+    {
+      return small_size_ + (large_ != nullptr ? large_->size () : 0);
+    }
+
+    // Return the approximate amount of memory (in bytes) that the entries
+    // occupy (see memory_stat).
+    //
+    size_t
+    bytes () const;
 
   public:
     // Global should be true if this map is part of the global build state
@@ -1475,8 +1591,19 @@ namespace build2
     variable_map (context& c, bool global = false)
       : ctx (&c), global_ (global) {}
 
+    variable_map (variable_map&&);
+    variable_map (const variable_map&);
+
+    variable_map& operator= (variable_map&&);
+    variable_map& operator= (const variable_map&);
+
+    ~variable_map () {clear ();}
+
     void
-    clear () {m_.clear ();}
+    clear ();
+
+    bool
+    global () const {return global_;}
 
     // Implementation details (only used for empty_variable_map).
     //
@@ -1490,14 +1617,124 @@ namespace build2
     void
     typify (const value_data&, const variable&) const;
 
+    // Small entry with the specified index (in the insertion order).
+    //
+    value_type&
+    small_at (size_t i) const
+    {
+      return i == 0 ? small_[0][0] : small_[1][i - 1];
+    }
+
+    // Small entry at the specified position in the ascending order.
+    //
+    value_type&
+    small_pos (size_t i) const {return small_at (small_order_[i]);}
+
+    value_type*
+    small_find (const variable&) const;
+
+    // Copy the small entries into the empty small array. If this throws,
+    // then the small array is left empty.
+    //
+    void
+    small_copy (const variable_map&);
+
+    void
+    small_clear ();
+
+    static map_type::key_compare
+    compare () {return map_type::key_compare ('.');}
+
   private:
     context* ctx;
-    map_type m_;
+
+    value_type* small_[2] = {nullptr, nullptr};
+    uint8_t small_size_ = 0;
+    uint8_t small_order_[small_capacity];
+
     bool global_;
+
+    unique_ptr<map_type> large_; // Entries beyond small_capacity.
   };
 
   LIBBUILD2_SYMEXPORT extern const variable_map empty_variable_map;
 
+  // Hash table that can be searched without locking (used by
+  // variable_cache and variable_lookup_memo).
+  //
+  // The buckets are lock-free singly-linked lists that are only prepended
+  // to and the entries are never removed (so if there are several entries
+  // with the same key, the most recently inserted one is found first). The
+  // entries are linked in the insertion order when the table is grown.
+  //
+  // Once published, a table is never modified other than by prepending
+  // nodes to its buckets. When the table is grown we link the entries anew
+  // into a new table but keep the old one around for any concurrent
+  // lookups that may still be traversing it.
+  //
+  // The entry type E should have the key data member which is hashed with
+  // the H function object.
+  //
+  template <typename E, typename H>
+  class variable_hash_table
+  {
+  public:
+    // MT-safe.
+    //
+    template <typename K>
+    E*
+    find (const K&, size_t hash) const;
+
+    // Construct a new entry from the arguments and link it, growing the
+    // table if necessary. Should only be called under an exclusive lock.
+    //
+    template <typename... A>
+    E&
+    insert (size_t hash, A&&...);
+
+    // Return the number of entries and the approximate memory they occupy
+    // (see memory_stat). Note: not MT-safe.
+    //
+    size_t
+    size () const {return entries_.size ();}
+
+    size_t
+    bytes () const;
+
+    variable_hash_table () = default;
+
+    // Note: not MT-safe (only used to move an empty table of a new scope).
+    //
+    variable_hash_table (variable_hash_table&&);
+
+    variable_hash_table (const variable_hash_table&) = delete;
+    variable_hash_table& operator= (const variable_hash_table&) = delete;
+
+  private:
+    struct node
+    {
+      E*    entry;
+      node* next; // Immutable once the node is published.
+    };
+
+    struct table
+    {
+      size_t                      size; // Number of buckets (power of 2).
+      unique_ptr<atomic<node*>[]> buckets;
+    };
+
+    void
+    link (table&, E&, size_t hash);
+
+    atomic<table*> table_ {nullptr};
+
+    // The following members are only accessed under the exclusive lock.
+    //
+    std::deque<E>             entries_;
+    std::deque<node>          nodes_;
+    vector<unique_ptr<table>> tables_; // Current last.
+  };
+
   // Value caching. Used for overrides as well as target type/pattern-specific
   // append/prepend.
   //
@@ -1508,9 +1745,16 @@ namespace build2
   // the references remain valid).
   //
   // Note that since the cache can be modified on any lookup (including during
-  // the execute phase), it is protected by its own mutex shard (see mutexes
-  // in context). This shard is also used for value typification (which is
-  // kind of like caching) during concurrent execution phases.
+  // the execute phase), modifications are protected by its own mutex shard
+  // (see mutexes in context). This shard is also used for value
+  // typification (which is kind of like caching) during concurrent
+  // execution phases.
+  //
+  // The cache can be searched without locking (see variable_hash_table).
+  // The entry versions (which are checked to detect a stale value) are
+  // atomic and are only published once the (exclusively-locked) update of
+  // the value is complete. So in the common case of a cache hit there is no
+  // locking. On a miss or invalidation we fall back to the exclusive lock.
   //
   template <typename K>
   class variable_cache
@@ -1527,9 +1771,44 @@ namespace build2
             size_t base_version,
             const variable&);
 
+    // Return the number of cached values and the approximate memory they
+    // occupy (see memory_stat). Note: not MT-safe.
+    //
+    size_t
+    size () const {return table_.size ();}
+
+    size_t
+    bytes () const {return table_.bytes ();}
+
+    variable_cache () = default;
+    variable_cache (variable_cache&&) = default;
+
+    variable_cache (const variable_cache&) = delete;
+    variable_cache& operator= (const variable_cache&) = delete;
+
   private:
+    // Versions of an entry. NULL/0 stem means there is no stem.
+    //
+    struct versions
+    {
+      size_t              base;       // Version on which value is based.
+      const variable_map* stem_vars;  // Location of the stem.
+      size_t              stem;       // Version of the stem.
+
+      bool
+      operator== (const versions& x) const
+      {
+        return base == x.base && stem_vars == x.stem_vars && stem == x.stem;
+      }
+
+      bool
+      operator!= (const versions& x) const {return !(*this == x);}
+    };
+
     struct entry_type
     {
+      const K key;
+
       // Note: we use value_data instead of value since the result is often
       // returned as lookup. We also maintain the version in case one cached
       // value (e.g., override) is based on another (e.g., target
@@ -1537,31 +1816,30 @@ namespace build2
       //
       variable_map::value_data value;
 
-      size_t base_version = 0; // Version on which this value is based.
-
-      // Location of the stem as well as the version on which this cache
-      // value is based. Used to track the location and value of the stem
-      // for cache invalidation. NULL/0 means there is no stem.
+      // The versions on which the value is (or is being) based. Only
+      // accessed under the exclusive lock.
       //
-      const variable_map* stem_vars = nullptr;
-      size_t              stem_version = 0;
+      versions current;
 
-      // For GCC 4.9.
+      // The versions that can be checked without a lock. The base version
+      // is stored last and is ~0 if the versions have not (yet) been
+      // published (that is, the value is being updated).
       //
-      entry_type () = default;
-      entry_type (variable_map::value_data val,
-                  size_t bver,
-                  const variable_map* svars,
-                  size_t sver)
-          : value (move (val)),
-            base_version (bver),
-            stem_vars (svars),
-            stem_version (sver) {}
+      atomic<size_t>              base_version {~size_t (0)};
+      atomic<const variable_map*> stem_vars    {nullptr};
+      atomic<size_t>              stem_version {0};
+
+      entry_type (K k, const versions& v)
+          : key (move (k)), value (nullptr), current (v) {}
     };
 
-    using map_type = std::map<K, entry_type>;
+    struct hasher
+    {
+      size_t
+      operator() (const K&) const;
+    };
 
-    map_type m_;
+    variable_hash_table<entry_type, hasher> table_;
   };
 
   // Variable override cache. Only on project roots (in scope::root_extra)
@@ -1626,8 +1904,14 @@ namespace build2
     const_iterator end ()   const {return map_.end ();}
     bool           empty () const {return map_.empty ();}
 
+    // If pattern is not NULL, then set it to true if the outcome depends on
+    // the target name (that is, a pattern other than `*` was considered).
+    //
     lookup
-    find (const target_type&, const string& tname, const variable&) const;
+    find (const target_type&,
+          const string& tname,
+          const variable&,
+          bool* pattern = nullptr) const;
 
     // Prepend/append value cache.
     //
@@ -1647,6 +1931,89 @@ namespace build2
     map_type map_;
     bool global_;
   };
+
+  // Variable lookup memo. Used to remember the outcome of looking up a
+  // variable in a scope, its target type/pattern-specific variables, and
+  // its outer scopes (see scope::lookup_original() for details) since the
+  // same lookups are repeated for every target in the directory.
+  //
+  // The key is the variable plus the target and group target types (NULL
+  // if not looking up for a target). Only outcomes that do not depend on the
+  // target name are memoized, that is, those where no pattern other than
+  // `*` was considered and no prepend/append was applied (the latter is
+  // cached in variable_type_map::cache, per target name).
+  //
+  // An entry is only valid as long as context::global_vars_version matches
+  // the one at which it was memoized (see variable_map::insert()). Since
+  // only changes to the global variable maps are tracked, the memo should
+  // only be used for scopes that are part of the global build state (and
+  // not, for example, for temp_scope). It is also pointless to memoize
+  // during load where the version changes on every assignment.
+  //
+  // The memo can be searched without locking (see variable_hash_table) and
+  // its entries are immutable once published (a newer entry for the same
+  // key shadows the older one). Insertions are protected by a mutex shard
+  // (the same as variable_cache).
+  //
+  class LIBBUILD2_SYMEXPORT variable_lookup_memo
+  {
+  public:
+    using key_type = tuple<const variable*,
+                           const target_type*,
+                           const target_type*>;
+
+    using result_type = pair<lookup, size_t>;
+
+    // Return the memoized outcome or NULL if there is none for this
+    // version. The version is that of context::global_vars_version obtained
+    // before the lookup.
+    //
+    const result_type*
+    find (const key_type&, size_t version) const;
+
+    void
+    insert (context&, const key_type&, size_t version, const result_type&);
+
+    // Return the number of entries and the approximate memory they occupy
+    // (see memory_stat). Note: not MT-safe.
+    //
+    size_t
+    size () const {return table_.size ();}
+
+    size_t
+    bytes () const {return table_.bytes ();}
+
+    variable_lookup_memo () = default;
+    variable_lookup_memo (variable_lookup_memo&&) = default;
+
+    variable_lookup_memo (const variable_lookup_memo&) = delete;
+    variable_lookup_memo& operator= (const variable_lookup_memo&) = delete;
+
+  private:
+    struct entry_type
+    {
+      const key_type    key;
+      const result_type result;
+      const size_t      version;
+
+      entry_type (const key_type& k, const result_type& r, size_t v)
+          : key (k), result (r), version (v) {}
+    };
+
+    struct hasher
+    {
+      size_t
+      operator() (const key_type& k) const
+      {
+        return combine_hash (
+          std::hash<const variable*> () (std::get<0> (k)),
+          std::hash<const target_type*> () (std::get<1> (k)),
+          std::hash<const target_type*> () (std::get<2> (k)));
+      }
+    };
+
+    variable_hash_table<entry_type, hasher> table_;
+  };
 }
 
 #include <libbuild2/variable.ixx>
@@ -822,6 +822,32 @@ namespace build2
     }
   }
 
+  // variable_map::base_iterator
+  //
+  inline bool variable_map::base_iterator::
+  small () const
+  {
+    return i_ != n_ &&
+      (j_ == je_ || compare () (m_->small_pos (i_).first, j_->first));
+  }
+
+  inline auto variable_map::base_iterator::
+  operator* () const -> reference
+  {
+    return small () ? m_->small_pos (i_) : *j_;
+  }
+
+  inline auto variable_map::base_iterator::
+  operator++ () -> base_iterator&
+  {
+    if (small ())
+      ++i_;
+    else
+      ++j_;
+
+    return *this;
+  }
+
   // variable_map::iterator_adapter
   //
   template <typename I>
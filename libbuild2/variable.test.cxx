@@ -0,0 +1,258 @@
+// file      : libbuild2/variable.test.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <cassert>
+#include <iostream>
+
+#include <libbuild2/types.hxx>
+#include <libbuild2/utility.hxx>
+
+#include <libbuild2/context.hxx>
+#include <libbuild2/scheduler.hxx>
+#include <libbuild2/variable.hxx>
+#include <libbuild2/diagnostics.hxx>
+
+using namespace std;
+
+namespace build2
+{
+  // Return the variable names in the specified range as a space-separated
+  // list.
+  //
+  template <typename I>
+  static string
+  names (I b, I e)
+  {
+    string r;
+    for (; b != e; ++b)
+    {
+      if (!r.empty ())
+        r += ' ';
+
+      r += b->first.get ().name;
+    }
+    return r;
+  }
+
+  static string
+  names (const variable_map& m)
+  {
+    return names (m.begin (), m.end ());
+  }
+
+  static string
+  names (const variable_map& m, const variable& ns)
+  {
+    auto r (m.lookup_namespace (ns));
+    return names (r.first, r.second);
+  }
+
+  int
+  main (int, char* argv[])
+  {
+    // Fake build system driver, default verbosity.
+    //
+    init_diag (1);
+    init (nullptr, argv[0]);
+
+    // Serial execution.
+    //
+    scheduler sched (1);
+    global_mutexes mutexes (1);
+    context ctx (sched, mutexes);
+
+    variable_pool& vp (ctx.var_pool.rw ());
+
+    // The first variable_map::small_capacity (3) entries are stored in the
+    // small array and the rest in the tree. Note that the entries are
+    // inserted out of order and namespaces are split between the two.
+    //
+    const variable& c   (vp.insert<string> ("c"));
+    const variable& a_y (vp.insert<string> ("a.y"));
+    const variable& x   (vp.insert<string> ("x"));
+    const variable& a   (vp.insert<string> ("a"));
+    const variable& b   (vp.insert<string> ("b"));
+    const variable& a_x (vp.insert<string> ("a.x"));
+    const variable& a_z (vp.insert<string> ("a.z"));
+    const variable& q   (vp.insert<string> ("q"));
+
+    const variable* vars[] = {&c, &a_y, &x, &a, &b, &a_x, &a_z};
+
+    variable_map m (ctx);
+
+    assert (m.empty () && m.size () == 0);
+    assert (m.begin () == m.end ());
+    assert (names (m, a).empty ());
+
+    // Small array only.
+    //
+    for (size_t i (0); i != 3; ++i)
+    {
+      auto p (m.insert (*vars[i]));
+      assert (p.second);
+      p.first.get () = vars[i]->name;
+    }
+
+    assert (m.size () == 3);
+    assert (names (m) == "a.y c x");
+    assert (names (m, a) == "a.y");
+
+    // Remember the value addresses: they should remain stable across the
+    // inserts (we hand out references to values).
+    //
+    const value* vc (m[c].value);
+    const value* vx (m[x].value);
+
+    // Small to large transition.
+    //
+    for (size_t i (3); i != 7; ++i)
+    {
+      auto p (m.insert (*vars[i]));
+      assert (p.second);
+      p.first.get () = vars[i]->name;
+    }
+
+    assert (m.size () == 7 && !m.empty ());
+
+    assert (m[c].value == vc && m[x].value == vx);
+
+    // Inserting an existing entry (small and large).
+    //
+    {
+      auto p (m.insert (c));
+      assert (!p.second && &p.first.get () == vc);
+    }
+
+    {
+      const value* vb (m[b].value);
+      auto p (m.insert (b));
+      assert (!p.second && &p.first.get () == vb);
+    }
+
+    assert (m.size () == 7);
+
+    // Lookup in both parts.
+    //
+    for (const variable* v: vars)
+    {
+      lookup l (m[*v]);
+      assert (l.defined () && l.vars == &m);
+      assert (cast<string> (l) == v->name);
+    }
+
+    assert (!m[q]);
+
+    // Iteration order across both parts.
+    //
+    assert (names (m) == "a a.x a.y a.z b c x");
+
+    // Namespace lookup: across both parts, only small, only large, and
+    // non-existent.
+    //
+    assert (names (m, a) == "a a.x a.y a.z");
+    assert (names (m, c) == "c");
+    assert (names (m, b) == "b");
+    assert (names (m, q).empty ());
+
+    // Copy.
+    //
+    {
+      variable_map cm (m);
+
+      assert (cm.size () == 7);
+      assert (names (cm) == names (m));
+      assert (names (cm, a) == names (m, a));
+
+      for (const variable* v: vars)
+      {
+        lookup l (cm[*v]);
+        assert (l.vars == &cm && l.value != m[*v].value);
+        assert (cast<string> (l) == v->name);
+      }
+
+      // Modifying the copy should not affect the original.
+      //
+      cm.assign (c) = string ("C");
+      cm.assign (b) = string ("B");
+
+      assert (cast<string> (m[c]) == "c" && cast<string> (m[b]) == "b");
+
+      // Copy assignment (over a map with entries).
+      //
+      cm = m;
+
+      assert (names (cm) == names (m));
+      assert (cast<string> (cm[c]) == "c" && cast<string> (cm[b]) == "b");
+
+      // Copy of a map with only small entries.
+      //
+      variable_map sm (ctx);
+      sm.assign (x) = string ("x");
+
+      cm = sm;
+      assert (cm.size () == 1 && names (cm) == "x");
+    }
+
+    // Move.
+    //
+    {
+      variable_map cm (m);
+
+      const value* pa (cm[a].value);
+      const value* pc (cm[c].value);
+
+      variable_map mm (move (cm));
+
+      assert (cm.empty () && cm.size () == 0 && cm.begin () == cm.end ());
+      assert (!cm[c] && !cm[a]);
+
+      // The entries themselves are not moved.
+      //
+      assert (mm.size () == 7 && names (mm) == names (m));
+      assert (mm[a].value == pa && mm[c].value == pc);
+
+      // Move assignment (over a map with entries).
+      //
+      variable_map am (ctx);
+      am.assign (q) = string ("q");
+
+      am = move (mm);
+
+      assert (mm.empty ());
+      assert (am.size () == 7 && names (am) == names (m));
+      assert (am[a].value == pa && am[c].value == pc);
+      assert (!am[q]);
+
+      // The moved-from map should be usable.
+      //
+      mm.assign (q) = string ("q");
+      assert (mm.size () == 1 && cast<string> (mm[q]) == "q");
+    }
+
+    // Clear (note that there is no erasing of individual entries).
+    //
+    {
+      variable_map cm (m);
+      cm.clear ();
+
+      assert (cm.empty () && cm.size () == 0 && cm.begin () == cm.end ());
+      assert (!cm[c] && !cm[a]);
+
+      // Refill after clearing (small and large again).
+      //
+      for (const variable* v: vars)
+        cm.assign (*v) = v->name;
+
+      assert (names (cm) == names (m));
+      assert (names (cm, a) == names (m, a));
+    }
+
+    return 0;
+  }
+}
+
+int
+main (int argc, char* argv[])
+{
+  return build2::main (argc, argv);
+}
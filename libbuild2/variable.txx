@@ -759,8 +759,126 @@ namespace build2
     &default_empty<map<K, V>>
   };
 
+  // variable_hash_table
+  //
+  template <typename E, typename H>
+  variable_hash_table<E, H>::
+  variable_hash_table (variable_hash_table&& x)
+      : table_ (x.table_.load (memory_order_relaxed)),
+        entries_ (move (x.entries_)),
+        nodes_ (move (x.nodes_)),
+        tables_ (move (x.tables_))
+  {
+    x.table_.store (nullptr, memory_order_relaxed);
+  }
+
+  template <typename E, typename H>
+  template <typename K>
+  E* variable_hash_table<E, H>::
+  find (const K& k, size_t h) const
+  {
+    if (const table* t = table_.load (memory_order_acquire))
+    {
+      for (const node* n (
+             t->buckets[h & (t->size - 1)].load (memory_order_acquire));
+           n != nullptr;
+           n = n->next)
+      {
+        if (n->entry->key == k)
+          return n->entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  template <typename E, typename H>
+  void variable_hash_table<E, H>::
+  link (table& t, E& e, size_t h)
+  {
+    atomic<node*>& b (t.buckets[h & (t.size - 1)]);
+
+    nodes_.push_back (node {&e, b.load (memory_order_relaxed)});
+    b.store (&nodes_.back (), memory_order_release);
+  }
+
+  template <typename E, typename H>
+  template <typename... A>
+  E& variable_hash_table<E, H>::
+  insert (size_t h, A&&... a)
+  {
+    table* t (table_.load (memory_order_relaxed));
+
+    // Grow the table if it becomes too full (or allocate the initial one).
+    // Note that we link the existing entries in the insertion order and
+    // before the new one so that the most recent entry for each key ends up
+    // first in its bucket.
+    //
+    if (t == nullptr || entries_.size () >= t->size)
+    {
+      size_t n (t == nullptr ? 8 : t->size * 2);
+
+      unique_ptr<table> nt (
+        new table {n, unique_ptr<atomic<node*>[]> (new atomic<node*>[n])});
+
+      for (size_t i (0); i != n; ++i)
+        nt->buckets[i].store (nullptr, memory_order_relaxed);
+
+      for (E& x: entries_)
+        link (*nt, x, H () (x.key));
+
+      tables_.push_back (move (nt));
+      t = tables_.back ().get ();
+      table_.store (t, memory_order_release);
+    }
+
+    entries_.emplace_back (forward<A> (a)...);
+    E& e (entries_.back ());
+    link (*t, e, h);
+    return e;
+  }
+
+  template <typename E, typename H>
+  size_t variable_hash_table<E, H>::
+  bytes () const
+  {
+    // The entries plus their nodes in all the tables (including the old
+    // ones) plus the buckets.
+    //
+    size_t r (entries_.size () * sizeof (E) +
+              nodes_.size () * sizeof (node));
+
+    for (const unique_ptr<table>& t: tables_)
+      r += sizeof (table) + t->size * sizeof (atomic<node*>);
+
+    return r;
+  }
+
   // variable_cache
   //
+  template <typename T1, typename T2>
+  inline size_t
+  variable_cache_hash (const pair<T1, T2>& k)
+  {
+    return combine_hash (hash<T1> () (k.first), hash<T2> () (k.second));
+  }
+
+  template <typename T1, typename T2, typename T3>
+  inline size_t
+  variable_cache_hash (const tuple<T1, T2, T3>& k)
+  {
+    return combine_hash (hash<T1> () (std::get<0> (k)),
+                         hash<T2> () (std::get<1> (k)),
+                         hash<T3> () (std::get<2> (k)));
+  }
+
+  template <typename K>
+  inline size_t variable_cache<K>::hasher::
+  operator() (const K& k) const
+  {
+    return variable_cache_hash (k);
+  }
+
   template <typename K>
   pair<value&, ulock> variable_cache<K>::
   insert (context& ctx,
@@ -776,75 +894,88 @@ namespace build2
                  ? static_cast<const value_data*> (stem.value)->version
                  : 0);
 
+    size_t h (hasher () (k));
+
+    // Cache hit without locking.
+    //
+    // Note that the base version is published last so we load it first.
+    //
+    entry_type* e (table_.find (k, h));
+
+    if (e != nullptr                                              &&
+        e->base_version.load (memory_order_acquire) == bver       &&
+        e->stem_vars.load (memory_order_relaxed)    == svars      &&
+        e->stem_version.load (memory_order_relaxed) == sver       &&
+        (var.type == nullptr ||
+         e->value.type.load (memory_order_acquire) == var.type))
+      return pair<value&, ulock> (e->value, ulock ());
+
     shared_mutex& m (
       ctx.mutexes.variable_cache[
         hash<variable_cache*> () (this) % ctx.mutexes.variable_cache_size]);
 
-    slock sl (m);
-    ulock ul (m, defer_lock);
-
-    auto i (m_.find (k));
+    ulock ul (m);
 
-    // Cache hit.
+    // Note that it is entirely possible that someone else has inserted or
+    // updated the entry while we were not holding the lock. We could also
+    // have missed it if the table was being grown.
     //
-    if (i != m_.end ()                 &&
-        i->second.base_version == bver &&
-        i->second.stem_vars == svars   &&
-        i->second.stem_version == sver &&
-        (var.type == nullptr || i->second.value.type == var.type))
-      return pair<value&, ulock> (i->second.value, move (ul));
-
-    // Relock for exclusive access. Note that it is entirely possible
-    // that between unlock and lock someone else has updated the entry.
-    //
-    sl.unlock ();
-    ul.lock ();
-
-    // Note that the cache entries are never removed so we can reuse the
-    // iterator.
-    //
-    pair<typename map_type::iterator, bool> p (i, i == m_.end ());
-
-    if (p.second)
-      p = m_.emplace (move (k),
-                      entry_type {value_data (nullptr), bver, svars, sver});
+    if (e == nullptr)
+      e = table_.find (k, h);
 
-    entry_type& e (p.first->second);
+    versions v {bver, svars, sver};
 
-    if (p.second)
+    if (e == nullptr)
     {
       // Cache miss.
       //
-      e.value.version++; // New value.
+      e = &table_.insert (h, move (k), v);
+      e->value.version++; // New value.
     }
-    else if (e.base_version != bver  ||
-             e.stem_vars    != svars ||
-             e.stem_version != sver)
+    else if (e->current != v)
     {
       // Cache invalidation.
       //
-      assert (e.base_version <= bver);
-      e.base_version = bver;
+      // First unpublish the versions so that lock-free lookups don't
+      // consider the value current while it's being updated.
+      //
+      e->base_version.store (~size_t (0), memory_order_release);
+
+      versions& c (e->current);
 
-      if (e.stem_vars != svars)
-        e.stem_vars = svars;
+      assert (c.base <= bver);
+      c.base = bver;
+
+      if (c.stem_vars != svars)
+        c.stem_vars = svars;
       else
-        assert (e.stem_version <= sver);
+        assert (c.stem <= sver);
 
-      e.stem_version = sver;
+      c.stem = sver;
 
-      e.value.version++; // Value changed.
+      e->value.version++; // Value changed.
     }
     else
     {
       // Cache hit.
       //
-      if (var.type != nullptr && e.value.type != var.type)
-        typify (e.value, *var.type, &var);
+      if (var.type != nullptr && e->value.type != var.type)
+        typify (e->value, *var.type, &var);
+
+      // Publish the versions if this is the first hit since the value has
+      // been updated (which was done while holding the lock that we now
+      // hold).
+      //
+      if (e->base_version.load (memory_order_relaxed) != bver)
+      {
+        e->stem_vars.store (svars, memory_order_relaxed);
+        e->stem_version.store (sver, memory_order_relaxed);
+        e->base_version.store (bver, memory_order_release);
+      }
 
       ul.unlock ();
     }
 
-    return pair<value&, ulock> (e.value, move (ul));
+    return pair<value&, ulock> (e->value, move (ul));
   }
 }
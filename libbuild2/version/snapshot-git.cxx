@@ -102,6 +102,7 @@ namespace build2
       args[args_i + 2] = "HEAD";
       args[args_i + 3] = nullptr;
 
+      process_span ps (args);
       process pr (run_start (3     /* verbosity */,
                              pp,
                              args,